@@ -29,9 +29,15 @@
 #error "fsmlite requires C++17 support."
 #endif
 
+#include <atomic>
 #include <cstddef>
+#include <new>
 #include <type_traits>
 
+#if __STDC_HOSTED__
+#include <cstring>
+#endif
+
 #if !defined(NDEBUG) && (!__GNUC__ || __EXCEPTIONS)
 #include <stdexcept>
 #endif
@@ -65,7 +71,11 @@ namespace fsmlite {
 
         template <class M, class T, class T1, class... Args>
         invoke_result_t<M T::*, T1, Args...> invoke(M T::* f, T1&& obj, Args&&... args) {
-            return (obj.*f)(args...);
+            if constexpr (std::is_member_object_pointer<M T::*>::value) {
+                return obj.*f;
+            } else {
+                return (obj.*f)(args...);
+            }
         }
 
         // use any of F(), F(Arg1), F(Arg2), F(Arg1, Arg2)
@@ -157,277 +167,3838 @@ namespace fsmlite {
         struct filter<Predicate> {
             using type = list<>;
         };
-    }
-
-    /**
-     * Finite state machine (FSM) base class template.
-     *
-     * @tparam Derived the derived state machine class
-     *
-     * @tparam State the FSM's state type, defaults to `int`
-     */
-    template<class Derived, class State = int>
-    class fsm {
-    public:
-        /**
-         * The FSM's state type.
-         */
-        typedef State state_type;
 
-    public:
-        /**
-         * Create a state machine with an optional initial state.
-         *
-         * @param init_state the FSM's initial state
-         */
-        fsm(state_type init_state = state_type()) : m_state(init_state) {}
+        // compile-time value as a type, e.g. for comparing guards
+        template<class T, T V> struct value_tag {};
 
-        /**
-         * Process an event.
-         *
-         * @warning This member function must not be called
-         * recursively, e.g. from another `fsm` instance.
-         *
-         * @tparam Event the event type
-         *
-         * @param event the event instance
-         *
-         * @throw std::logic_error if a recursive invocation is
-         * detected
-         */
-        template<class Event>
-        void process_event(const Event& event) {
-            using rows = typename by_event_type<Event, typename Derived::transition_table>::type;
-            processing_lock lock(*this);
-            static_assert(std::is_base_of<fsm, Derived>::value, "must derive from fsm");
-            Derived& self = static_cast<Derived&>(*this);
-            m_state = handle_event<Event, rows>::execute(self, event, m_state);
+        // 1 if a guard always holds, 0 if it never holds, -1 otherwise
+        template<class T, T guard>
+        constexpr int guard_constant(value_tag<T, guard>) {
+            if constexpr (std::is_same<T, bool>::value) {
+                return guard ? 1 : 0;
+            } else if constexpr (std::is_null_pointer<T>::value) {
+                return 1;
+            } else if constexpr (std::is_pointer<T>::value || std::is_member_pointer<T>::value) {
+                return guard == nullptr ? 1 : -1;
+            } else {
+                return -1;
+            }
         }
 
-        /**
-         * Return the state machine's current state.
-         */
-        state_type current_state() const { return m_state; }
+        // a column guard is a pointer to a data member, which can be
+        // evaluated over a batch of instances without calls
+        template<class Tag>
+        struct is_column_guard : std::false_type {};
 
-    protected:
-        /**
-         * Called when no transition can be found for the given event
-         * in the current state.  Derived state machines may override
-         * this to throw an exception, or change to some other (error)
-         * state.  The default is to return the current state, so no
-         * state change occurs.
-         *
-         * @tparam Event the event type
-         *
-         * @param event the event instance
-         *
-         * @return the FSM's new state
-         */
-        template<class Event>
-        state_type no_transition(const Event& /*event*/) {
-            return m_state;
+        template<class T, T guard>
+        struct is_column_guard<value_tag<T, guard>> : std::is_member_object_pointer<T> {};
+
+        template<class T, T V>
+        constexpr T tag_value(value_tag<T, V>) {
+            return V;
         }
 
-    private:
-        template<State start, class Event, State target>
-        struct row_base {
-            using state_type = State;
-            using event_type = Event;
+        // remove duplicate types, keeping the first occurrence
+        template<class List, class... Types>
+        struct unique {
+            using type = List;
+        };
 
-            static constexpr state_type start_value() { return start; }
-            static constexpr state_type target_value() { return target; }
+        template<class... Done, class T, class... Types>
+        struct unique<list<Done...>, T, Types...> : unique<
+            typename std::conditional<
+                (std::is_same<T, Done>::value || ...), list<Done...>, list<Done..., T>
+            >::type,
+            Types...
+        > {};
 
-        protected:
-            template<class Action>
-            static void process_event(Action&& action, Derived& self, const Event& event) {
-                detail::invoke_as_binary_fn(action, self, event);
-            }
+        // apply a variadic template to the elements of a list
+        template<template<class...> class F, class List> struct apply;
 
-            // clang++-5.0: constexpr function's return type 'void' is not a literal type
-            static /*constexpr*/ void process_event(std::nullptr_t, Derived& /*self*/, const Event& /*event*/) {
-            }
+        template<template<class...> class F, class... Types>
+        struct apply<F, list<Types...>> {
+            using type = F<Types...>;
+        };
 
-            template<class Guard>
-            static bool check_guard(Guard&& guard, const Derived& self, const Event& event) {
-                return detail::invoke_as_binary_fn(guard, self, event);
+        // lookup of the index of a unique key in a compile-time set
+        // of keys; uses a jump table for contiguous keys, and a
+        // multiplicative perfect hash function for sparse ones
+        template<unsigned long long... Keys>
+        struct key_table {
+            static constexpr std::size_t size = sizeof...(Keys);
+            static constexpr unsigned long long keys[] = { Keys... };
+
+            static constexpr unsigned long long min_key() {
+                unsigned long long k = keys[0];
+                for (unsigned long long key : keys) {
+                    k = key < k ? key : k;
+                }
+                return k;
             }
 
-            static constexpr bool check_guard(std::nullptr_t, const Derived&, const Event&) {
+            static constexpr bool is_unique() {
+                for (std::size_t i = 0; i != size; ++i) {
+                    for (std::size_t j = 0; j != i; ++j) {
+                        if (keys[i] == keys[j]) {
+                            return false;
+                        }
+                    }
+                }
                 return true;
             }
-        };
 
-    protected:
-        /**
-         * Transition table variadic class template.
-         *
-         * Each derived state machine class must define a nested
-         * non-template type `transition_table` that's either derived
-         * from or a type alias of `table`.
-         */
-        template<class... Rows> using table = detail::list<Rows...>;
+            static_assert(is_unique(), "duplicate keys");
 
-        /**
-         * Basic transition class template.
-         *
-         * @tparam start the start state of the transition
-         *
-         * @tparam Event the event type triggering the transition
-         *
-         * @tparam target the target state of the transition
-         *
-         * @tparam Action an action function type, or `std::nullptr_t`
-         *
-         * @tparam action a static `Action` instance
-         *
-         * @tparam Guard a guard function type, or `std::nullptr_t`
-         *
-         * @tparam guard a static `Guard` instance
-         */
-        template<
-            State start,
-            class Event,
-            State target,
-            class Action = std::nullptr_t,
-            Action action = nullptr,
-            class Guard = std::nullptr_t,
-            Guard guard = nullptr
-        >
-        struct basic_row : public row_base<start, Event, target> {
-            static void process_event(Derived& self, const Event& event) {
-                row_base<start, Event, target>::process_event(action, self, event);
+            static constexpr bool is_dense() {
+                for (unsigned long long key : keys) {
+                    if (key - min_key() >= size) {
+                        return false;
+                    }
+                }
+                return true;
             }
 
-            static bool check_guard(const Derived& self, const Event& event) {
-                return row_base<start, Event, target>::check_guard(guard, self, event);
+            static constexpr unsigned hash(unsigned long long key, unsigned long long mult, unsigned bits) {
+                return static_cast<unsigned>((key * mult) >> (64 - bits));
             }
-        };
 
-        /**
-         * Member function transition class template.
-         *
-         * @tparam start the start state of the transition
-         *
-         * @tparam Event the event type triggering the transition
-         *
-         * @tparam target the target state of the transition
-         *
-         * @tparam action an action member function, or `nullptr`
-         *
-         * @tparam guard a guard member function, or `nullptr`
-         *
-         * @deprecated since version 1.0
-         */
-        template<
-            State start,
-            class Event,
-            State target,
-            void (Derived::*action)(const Event&) = nullptr,
-            bool (Derived::*guard)(const Event&) const = nullptr
-        >
-        struct mem_fn_row : public row_base<start, Event, target> {
-            static void process_event(Derived& self, const Event& event) {
-                if (action != nullptr) {
-                    row_base<start, Event, target>::process_event(action, self, event);
+            struct hash_params {
+                unsigned long long mult;
+                unsigned bits;
+            };
+
+            static constexpr hash_params find_hash() {
+                unsigned bits = 1;
+                while ((std::size_t(1) << bits) < size) {
+                    ++bits;
+                }
+                for (unsigned maxbits = bits + 4; bits <= maxbits; ++bits) {
+                    unsigned long long mult = 0x9e3779b97f4a7c15ull;
+                    for (int n = 0; n != 1000; ++n) {
+                        bool ok = true;
+                        for (std::size_t i = 0; ok && i != size; ++i) {
+                            for (std::size_t j = 0; ok && j != i; ++j) {
+                                ok = hash(keys[i], mult, bits) != hash(keys[j], mult, bits);
+                            }
+                        }
+                        if (ok) {
+                            return { mult, bits };
+                        }
+                        mult = (mult ^ (mult >> 29)) * 0xbf58476d1ce4e5b9ull | 1;
+                    }
                 }
+                return { 0, 0 };
             }
 
-            static bool check_guard(const Derived& self, const Event& event) {
-                if (guard != nullptr) {
-                    return row_base<start, Event, target>::check_guard(guard, self, event);
-                } else {
-                    return true;
+            static constexpr bool dense = is_dense();
+
+            static constexpr hash_params params = dense ? hash_params{ 0, 0 } : find_hash();
+
+            static_assert(dense || params.bits != 0, "no perfect hash function found for keys");
+
+            static constexpr std::size_t slots = dense ? size : std::size_t(1) << params.bits;
+
+            struct lookup_table {
+                unsigned long long key[slots] = {};
+                std::size_t index[slots] = {};
+            };
+
+            static constexpr lookup_table make_table() {
+                lookup_table t;
+                for (std::size_t i = 0; i != slots; ++i) {
+                    t.index[i] = size;
                 }
+                for (std::size_t i = 0; i != size; ++i) {
+                    std::size_t h = dense ? keys[i] - min_key() : hash(keys[i], params.mult, params.bits);
+                    t.key[h] = keys[i];
+                    t.index[h] = i;
+                }
+                return t;
             }
-        };
 
-        /**
-         * Generic transition class template.
-         *
-         * @tparam start the start state of the transition
-         *
-         * @tparam Event the event type triggering the transition
-         *
-         * @tparam target the target state of the transition
-         *
-         * @tparam action a static action function pointer, or `nullptr`
-         *
-         * @tparam guard a static guard function pointer, or `nullptr`
-         */
-        template<
-            State start,
-            class Event,
-            State target,
-            auto action = nullptr,
-            auto guard = nullptr
-        >
-        struct row : public row_base<start, Event, target> {
-            static void process_event(Derived& self, const Event& event) {
-                row_base<start, Event, target>::process_event(action, self, event);
-            }
+            static constexpr lookup_table table = make_table();
 
-            static bool check_guard(const Derived& self, const Event& event) {
-                return row_base<start, Event, target>::check_guard(guard, self, event);
+            // return the index of key, or size if not found
+            static std::size_t find(unsigned long long key) {
+                if constexpr (dense) {
+                    unsigned long long offset = key - min_key();
+                    return offset < size ? table.index[offset] : size;
+                } else {
+                    unsigned h = hash(key, params.mult, params.bits);
+                    return table.key[h] == key ? table.index[h] : size;
+                }
             }
         };
 
-    private:
-        template<class Event, class...> struct by_event_type;
+        // rows may customize how transitions are executed
+        template<class T, class = void>
+        struct has_transition : std::false_type {};
 
-        template<class Event, class... Types>
-        struct by_event_type<Event, detail::list<Types...>> {
-            template<class T> using predicate = std::is_same<typename T::event_type, Event>;
-            using type = typename detail::filter<predicate, Types...>::type;
-        };
+        template<class T>
+        struct has_transition<T, std::void_t<decltype(&T::transition)>> : std::true_type {};
 
-        template<class Event>
-        struct by_event_type<Event, detail::list<>> {
-            using type = detail::list<>;
+        // index of a type in a list, or the list's size if not found
+        template<class T, class List> struct index_of;
+
+        template<class T, class... Types>
+        struct index_of<T, list<Types...>> {
+            static constexpr std::size_t find() {
+                constexpr bool match[] = { std::is_same<T, Types>::value..., true };
+                std::size_t index = 0;
+                while (!match[index]) {
+                    ++index;
+                }
+                return index;
+            }
+
+            static constexpr std::size_t value = find();
         };
 
-        template<class Event, class...> struct handle_event;
+        // number of cache-line padded shards for metrics counters
+        constexpr std::size_t metrics_shards = 16;
 
-        template<class Event, class T, class... Types>
-        struct handle_event<Event, detail::list<T, Types...>> {
-            static State execute(Derived& self, const Event& event, State state) {
-                return state == T::start_value() && T::check_guard(self, event) ?
-                    T::process_event(self, event), T::target_value() :
-                    handle_event<Event, detail::list<Types...>>::execute(self, event, state);
+        // shard of the calling thread, assigned round-robin
+        inline std::size_t metrics_shard() noexcept {
+#if __STDC_HOSTED__
+            static std::atomic<std::size_t> next(0);
+            thread_local std::size_t shard = next.fetch_add(1, std::memory_order_relaxed) % metrics_shards;
+            return shard;
+#else
+            return 0;
+#endif
+        }
+
+        // read one byte per cache line, so a table is paged in and
+        // cached before its first use
+        inline std::size_t touch(const void* p, std::size_t size) noexcept {
+            const volatile unsigned char* bytes = static_cast<const volatile unsigned char*>(p);
+            for (std::size_t i = 0; i < size; i += 64) {
+                static_cast<void>(bytes[i]);
             }
+            return size;
+        }
+
+        // type-erased transition functions of a row
+        struct row_thunks {
+            bool (*guard)(const void* self, const void* event);
+            void (*transition)(void* self, const void* event, void* state);
         };
 
-        template<class Event>
-        struct handle_event<Event, detail::list<>> {
-            static State execute(Derived& self, const Event& event, State) {
-                return self.no_transition(event);
-            }
+        // state type used for selecting rows, so that tables which
+        // only differ in their enumeration state types share code
+        template<class State, class = void>
+        struct selector_state {
+            using type = State;
         };
 
-    private:
-        state_type m_state;
+        template<class State>
+        struct selector_state<State, typename std::enable_if<std::is_enum<State>::value>::type> {
+            using type = typename std::underlying_type<State>::type;
+        };
 
-    private:
-#if !defined(NDEBUG) && (!__GNUC__ || __EXCEPTIONS)
-        class processing_lock {
-        public:
-            processing_lock(fsm& m) : processing(m.processing) {
-                if (processing) {
-                    throw std::logic_error("process_event called recursively");
+        // select the first row matching a start state whose guard
+        // holds; independent of the state machine and event types
+        template<class State, State... starts>
+        struct row_selector {
+            static std::size_t select(State state, const row_thunks* rows, const void* self, const void* event) {
+                constexpr State values[] = { starts... };
+                for (std::size_t i = 0; i != sizeof...(starts); ++i) {
+                    if (state == values[i] && (!rows[i].guard || rows[i].guard(self, event))) {
+                        return i;
+                    }
                 }
-                processing = true;
-            }
-            ~processing_lock() {
-                processing = false;
+                return sizeof...(starts);
             }
-        private:
-            bool& processing;
         };
-        bool processing = false;
+
+        // character classes provide a static contains() predicate
+        template<class T, class = void>
+        struct is_char_class : std::false_type {};
+
+        template<class T>
+        struct is_char_class<T, std::void_t<decltype(T::contains((unsigned char)0))>>
+            : std::is_same<decltype(T::contains((unsigned char)0)), bool> {};
+
+        // smallest unsigned type that can represent values [0, N]
+        template<std::size_t N>
+        using uint_for = typename std::conditional<
+            (N <= 0xff), unsigned char, typename std::conditional<
+                (N <= 0xffff), unsigned short, unsigned int
+            >::type
+        >::type;
+
+        // std::memchr() is in <cstring>, which may not be present on
+        // freestanding implementations
+        inline const char* find_char(const char* first, const char* last, char c) {
+#if __STDC_HOSTED__
+            const void* p = std::memchr(first, c, static_cast<std::size_t>(last - first));
+            return p ? static_cast<const char*>(p) : last;
 #else
-        struct processing_lock {
-            processing_lock(fsm&) {}
+            while (first != last && *first != c) {
+                ++first;
+            }
+            return first;
+#endif
+        }
+    }
+
+    /**
+     * Character class matching any of the given characters.
+     *
+     * Character classes may be used as event types of transition
+     * table rows processed by `fsm::process_bytes()`.
+     *
+     * @tparam Cs the characters contained in this class
+     */
+    template<char... Cs>
+    struct chars {
+        static constexpr bool contains(unsigned char c) {
+            return ((c == static_cast<unsigned char>(Cs)) || ...);
+        }
+    };
+
+    /**
+     * Character class matching all but the given characters.
+     *
+     * @tparam Cs the characters not contained in this class
+     */
+    template<char... Cs>
+    struct not_chars {
+        static constexpr bool contains(unsigned char c) {
+            return !chars<Cs...>::contains(c);
+        }
+    };
+
+    /**
+     * Character class matching a closed range of characters.
+     *
+     * @tparam First the first character of the range
+     *
+     * @tparam Last the last character of the range
+     */
+    template<char First, char Last>
+    struct char_range {
+        static constexpr bool contains(unsigned char c) {
+            return static_cast<unsigned char>(First) <= c && c <= static_cast<unsigned char>(Last);
+        }
+    };
+
+    /**
+     * Character class matching any character.
+     */
+    struct any_char {
+        static constexpr bool contains(unsigned char) {
+            return true;
+        }
+    };
+
+    /**
+     * Pure guard trait class template.
+     *
+     * Specialize this to derive from `std::true_type` for guards
+     * whose result only depends on their arguments, so it cannot
+     * change during a single call to `fsm::process_event()`.  Rows
+     * with the same start state and an identical pure guard as a
+     * preceding row can never fire, and are removed from the
+     * transition table at compile time.  Thus, a pure guard is
+     * evaluated at most once per event.
+     *
+     * @tparam guard the guard function or member function pointer
+     */
+    template<auto guard>
+    struct is_pure_guard : std::false_type {};
+
+    /**
+     * Event ID trait class template.
+     *
+     * Event IDs map runtime identifiers, e.g. wire protocol opcodes,
+     * to event types.  By default, an event type's ID is given by its
+     * static constant data member `id`.  Specialize this to derive
+     * from `std::integral_constant` for other event types.
+     *
+     * @tparam Event the event type
+     */
+    template<class Event, class = void>
+    struct event_id {};
+
+    template<class Event>
+    struct event_id<Event, std::void_t<decltype(Event::id)>>
+        : std::integral_constant<typename std::remove_cv<decltype(Event::id)>::type, Event::id> {};
+
+    /**
+     * State key trait class template.
+     *
+     * State keys are used for hashing states, e.g. by hashed
+     * dispatch.  For integral and enumeration state types, a state's
+     * key is its integral value.  Specialize this to provide a static
+     * constexpr member function `get()` returning a unique `unsigned
+     * long long` key for other state types.
+     *
+     * @tparam State the state type
+     */
+    template<class State, class = void>
+    struct state_key {};
+
+    template<class State>
+    struct state_key<State, typename std::enable_if<std::is_integral<State>::value || std::is_enum<State>::value>::type> {
+        static constexpr unsigned long long get(State state) {
+            return static_cast<unsigned long long>(state);
+        }
+    };
+
+    namespace detail {
+        template<class Event, class = void>
+        struct has_event_id : std::false_type {};
+
+        template<class Event>
+        struct has_event_id<Event, std::void_t<decltype(event_id<Event>::value)>> : std::true_type {};
+    }
+
+    /**
+     * Completion event type.
+     *
+     * Transition table rows with this event type are completion
+     * transitions, which are executed by `fsm::process_event()` as
+     * soon as their start state has been entered and their guard
+     * holds, without an external event.  Completion transitions must
+     * not form cycles, which is checked at compile time.
+     */
+    struct completion {};
+
+    /**
+     * Event name trait class template.
+     *
+     * Event names are used when exporting transition tables, e.g. by
+     * `fsm::write_dot()`.  By default, an event type's name is given
+     * by its static constant data member `name`, if present.
+     * Specialize this to provide a static constant data member
+     * `value` of type `const char*` for other event types.
+     *
+     * @tparam Event the event type
+     */
+    template<class Event, class = void>
+    struct event_name {
+        static constexpr const char* value = nullptr;
+    };
+
+    template<class Event>
+    struct event_name<Event, std::void_t<decltype(Event::name)>> {
+        static constexpr const char* value = Event::name;
+    };
+
+    template<>
+    struct event_name<completion> {
+        static constexpr const char* value = "completion";
+    };
+
+    /**
+     * Event coalescing trait class template.
+     *
+     * Coalescable events are idempotent, i.e. processing two
+     * duplicate events in a row has the same effect as processing
+     * one of them, so `event_queue` may skip all but the last of a
+     * run of queued duplicates.  Two events are duplicates if they
+     * compare equal or, if the event type provides no equality
+     * operator, if they are of the same type.  By default, an event
+     * type is coalescable if its static constant data member
+     * `coalesce` is `true`.  Specialize this to derive from
+     * `std::true_type` for other event types.
+     *
+     * @tparam Event the event type
+     */
+    template<class Event, class = void>
+    struct event_coalesce : std::false_type {};
+
+    template<class Event>
+    struct event_coalesce<Event, std::void_t<decltype(Event::coalesce)>>
+        : std::integral_constant<bool, Event::coalesce> {};
+
+    namespace detail {
+        // only used in unevaluated contexts
+        template<class T>
+        const T& const_ref() noexcept;
+
+        template<class T, class = void>
+        struct is_equality_comparable : std::false_type {};
+
+        template<class T>
+        struct is_equality_comparable<T, std::void_t<decltype(const_ref<T>() == const_ref<T>())>> : std::true_type {};
+
+        // std::to_chars() is in <charconv>, which may not be present
+        // on freestanding implementations
+        template<class Writer>
+        void write_number(Writer& out, long long value) {
+            char buf[24];
+            char* p = buf + sizeof(buf);
+            unsigned long long n = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : value;
+            *--p = '\0';
+            do {
+                *--p = static_cast<char>('0' + n % 10);
+                n /= 10;
+            } while (n);
+            if (value < 0) {
+                *--p = '-';
+            }
+            out(p);
+        }
+
+        // write a string with quotes and backslashes escaped
+        template<class Writer>
+        void write_quoted(Writer& out, const char* s) {
+            char buf[3] = {};
+            out("\"");
+            for (; *s; ++s) {
+                buf[0] = *s == '"' || *s == '\\' ? '\\' : *s;
+                buf[1] = *s == '"' || *s == '\\' ? *s : '\0';
+                out(buf);
+            }
+            out("\"");
+        }
+
+        template<class Writer, class Event, class Events>
+        void write_event_name(Writer& out) {
+            if (const char* name = event_name<Event>::value) {
+                write_quoted(out, name);
+            } else {
+                out("\"#");
+                write_number(out, static_cast<long long>(Events::template index_of<Event>()));
+                out("\"");
+            }
+        }
+    }
+
+    template<class Events, std::size_t Capacity>
+    class event_pool;
+
+    template<class Machine, std::size_t Capacity>
+    class population;
+
+    /**
+     * Event handle class template.
+     *
+     * Event handles refer to events stored in an `event_pool`, and
+     * may be passed to `fsm::process_event()` in place of the event
+     * itself.  A handle is invalidated when its pool is recycled.
+     *
+     * @tparam Event the event type
+     */
+    template<class Event>
+    class event_handle {
+    public:
+        /**
+         * Create an empty handle.
+         */
+        event_handle() noexcept : m_event(nullptr) {}
+
+        /**
+         * Return whether the handle refers to an event.
+         */
+        explicit operator bool() const noexcept { return m_event != nullptr; }
+
+        /**
+         * Return the event the handle refers to.
+         */
+        Event& operator*() const noexcept { return *m_event; }
+
+        /**
+         * Return a pointer to the event the handle refers to.
+         */
+        Event* operator->() const noexcept { return m_event; }
+
+        /**
+         * Return a pointer to the event the handle refers to, or
+         * `nullptr` if the handle is empty.
+         */
+        Event* get() const noexcept { return m_event; }
+
+    private:
+        template<class, std::size_t> friend class event_pool;
+
+        explicit event_handle(Event* event) noexcept : m_event(event) {}
+
+        Event* m_event;
+    };
+
+    /**
+     * Event type list class template.
+     *
+     * Event lists provide runtime dispatch of events identified by
+     * their zero-based index in the list, e.g. when replaying events
+     * from a binary log of fixed-layout records.  Events are passed
+     * by pointer and processed in place, without being copied.
+     *
+     * @tparam Events the event types
+     */
+    template<class... Events>
+    struct event_list {
+        /**
+         * Return the number of event types.
+         */
+        static constexpr std::size_t size() { return sizeof...(Events); }
+
+        /**
+         * Return the index of an event type.
+         *
+         * @tparam Event the event type
+         *
+         * @return the index of `Event`, or `size()` if `Event` is
+         * not contained in this list
+         */
+        template<class Event>
+        static constexpr std::size_t index_of() {
+            constexpr bool match[] = { std::is_same<Event, Events>::value..., true };
+            std::size_t index = 0;
+            while (!match[index]) {
+                ++index;
+            }
+            return index;
+        }
+
+        /**
+         * Process an event identified by its index.
+         *
+         * @tparam Target a state machine, or any other type providing
+         * a `process_event()` member function template
+         *
+         * @param target the target to process the event
+         *
+         * @param index the index of the event type
+         *
+         * @param data pointer to an event of the indexed type
+         *
+         * @return `false` if `index` is out of range
+         */
+        template<class Target>
+        static bool process_event(Target& target, std::size_t index, const void* data) {
+            if constexpr (sizeof...(Events) != 0) {
+                if (index < size()) {
+                    thunks<Target>[index](target, data);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Process an event identified by its event ID.
+         *
+         * Event IDs are given by the `event_id` trait, and must be
+         * unique.  If the IDs are contiguous, they are looked up
+         * using a jump table, otherwise using a perfect hash table
+         * generated at compile time.
+         *
+         * @tparam Target a state machine, or any other type providing
+         * a `process_event()` member function template
+         *
+         * @param target the target to process the event
+         *
+         * @param id the ID of the event type
+         *
+         * @param data pointer to an event of the identified type
+         *
+         * @return `false` if no event type has the given ID
+         */
+        template<class Target, class Id>
+        static bool process_event_id(Target& target, Id id, const void* data) {
+            if constexpr (sizeof...(Events) != 0) {
+                using ids = detail::key_table<static_cast<unsigned long long>(event_id<Events>::value)...>;
+                return process_event(target, ids::find(static_cast<unsigned long long>(id)), data);
+            } else {
+                return false;
+            }
+        }
+
+    private:
+        template<class Target, class Event>
+        static void thunk(Target& target, const void* data) {
+            target.process_event(*static_cast<const Event*>(data));
+        }
+
+        template<class Target>
+        using thunk_type = void (*)(Target&, const void*);
+
+        template<class Target>
+        static constexpr thunk_type<Target> thunks[sizeof...(Events)] = { &thunk<Target, Events>... };
+    };
+
+    /**
+     * Event type set class template.
+     *
+     * A fixed-size bit set of the event types in an `event_list`, as
+     * returned by `fsm::accepted_events()`.
+     *
+     * @tparam Events an `event_list` of the event types
+     */
+    template<class Events>
+    class event_set {
+        static constexpr std::size_t bits = 8 * sizeof(unsigned long long);
+        static constexpr std::size_t words = Events::size() ? (Events::size() + bits - 1) / bits : 1;
+
+    public:
+        /**
+         * The event types in this set.
+         */
+        typedef Events event_types;
+
+        /**
+         * Create an empty event type set.
+         */
+        constexpr event_set() : m_words() {}
+
+        /**
+         * Return whether an event type is contained in this set.
+         *
+         * @tparam Event the event type
+         */
+        template<class Event>
+        constexpr bool contains() const {
+            return test(Events::template index_of<Event>());
+        }
+
+        /**
+         * Return whether the event type with the given index in
+         * `Events` is contained in this set.
+         *
+         * @param index the index of the event type
+         */
+        constexpr bool test(std::size_t index) const {
+            return index < Events::size() && (m_words[index / bits] >> (index % bits)) & 1;
+        }
+
+        /**
+         * Add the event type with the given index in `Events` to this
+         * set.
+         *
+         * @param index the index of the event type
+         */
+        constexpr event_set& set(std::size_t index) {
+            if (index < Events::size()) {
+                m_words[index / bits] |= 1ull << (index % bits);
+            }
+            return *this;
+        }
+
+        /**
+         * Return the number of event types in this set.
+         */
+        constexpr std::size_t count() const {
+            std::size_t n = 0;
+            for (unsigned long long w : m_words) {
+                for (; w; w &= w - 1) {
+                    ++n;
+                }
+            }
+            return n;
+        }
+
+        /**
+         * Return whether this set is empty.
+         */
+        constexpr bool empty() const {
+            return count() == 0;
+        }
+
+        friend constexpr event_set operator|(const event_set& lhs, const event_set& rhs) {
+            event_set result;
+            for (std::size_t i = 0; i != words; ++i) {
+                result.m_words[i] = lhs.m_words[i] | rhs.m_words[i];
+            }
+            return result;
+        }
+
+        friend constexpr event_set operator&(const event_set& lhs, const event_set& rhs) {
+            event_set result;
+            for (std::size_t i = 0; i != words; ++i) {
+                result.m_words[i] = lhs.m_words[i] & rhs.m_words[i];
+            }
+            return result;
+        }
+
+        friend constexpr bool operator==(const event_set& lhs, const event_set& rhs) {
+            for (std::size_t i = 0; i != words; ++i) {
+                if (lhs.m_words[i] != rhs.m_words[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        friend constexpr bool operator!=(const event_set& lhs, const event_set& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        unsigned long long m_words[words];
+    };
+
+    /**
+     * State machine metrics class template.
+     *
+     * Metrics are aggregated over all instances of a state machine
+     * class, and returned by `fsm::metrics_snapshot()`.
+     *
+     * @tparam Events an `event_list` of the transition table's event
+     * types
+     *
+     * @tparam Rows the number of rows in the transition table
+     */
+    template<class Events, std::size_t Rows>
+    struct metrics {
+        /**
+         * The event types, in the order of their counters.
+         */
+        typedef Events event_types;
+
+        /**
+         * The number of events processed, by event type index.
+         */
+        unsigned long events[Events::size() + 1];
+
+        /**
+         * The number of events without a matching transition, by
+         * event type index.
+         */
+        unsigned long no_transitions[Events::size() + 1];
+
+        /**
+         * The number of transitions, by transition table row index.
+         */
+        unsigned long transitions[Rows + 1];
+
+        /**
+         * Return the number of processed events of a given type.
+         */
+        template<class Event>
+        constexpr unsigned long processed() const {
+            return events[Events::template index_of<Event>()];
+        }
+
+        /**
+         * Return the number of events of a given type without a
+         * matching transition.
+         */
+        template<class Event>
+        constexpr unsigned long rejected() const {
+            return no_transitions[Events::template index_of<Event>()];
+        }
+    };
+
+    /**
+     * Runtime transition table row.
+     *
+     * Rows of runtime transition tables refer to states, events,
+     * actions and guards by number, so they can be loaded from a
+     * compact binary file, or parsed from a text representation.
+     */
+    struct runtime_row {
+        /**
+         * The start state of the transition.
+         */
+        unsigned short start;
+
+        /**
+         * The index of the event type in the table's event list.
+         */
+        unsigned short event;
+
+        /**
+         * The target state of the transition.
+         */
+        unsigned short target;
+
+        /**
+         * The one-based index of the action in the action registry,
+         * or zero for no action.
+         */
+        unsigned short action;
+
+        /**
+         * The one-based index of the guard in the guard registry, or
+         * zero for no guard.
+         */
+        unsigned short guard;
+    };
+
+    /**
+     * Runtime transition table class template.
+     *
+     * Runtime transition tables are loaded from an array of
+     * `runtime_row` at runtime, and compiled into a flat `[state]
+     * [event]` dispatch array.  Actions and guards are bound to
+     * member or free functions through registries of `action_type`
+     * and `guard_type` instances.  A runtime table may be shared
+     * between any number of state machines, which process events
+     * using `fsm::process_event(const Table&, const Event&)`.
+     *
+     * @tparam Derived the derived state machine class
+     *
+     * @tparam Events an `event_list` of the event types to process
+     *
+     * @tparam MaxStates the maximum number of states
+     *
+     * @tparam MaxRows the maximum number of rows
+     */
+    template<class Derived, class Events, std::size_t MaxStates, std::size_t MaxRows>
+    class runtime_table {
+        using index_type = detail::uint_for<MaxRows>;
+
+        static constexpr std::size_t events = Events::size();
+        static constexpr index_type none = static_cast<index_type>(MaxRows);
+
+        template<class Event, auto action>
+        static void invoke_action(Derived& self, const void* event) {
+            detail::invoke_as_binary_fn(action, self, *static_cast<const Event*>(event));
+        }
+
+        template<class Event, auto guard>
+        static bool invoke_guard(const Derived& self, const void* event) {
+            return detail::invoke_as_binary_fn(guard, self, *static_cast<const Event*>(event));
+        }
+
+    public:
+        /**
+         * Action registry entry type.
+         */
+        struct action_type {
+            std::size_t event;
+            void (*invoke)(Derived&, const void*);
+        };
+
+        /**
+         * Guard registry entry type.
+         */
+        struct guard_type {
+            std::size_t event;
+            bool (*invoke)(const Derived&, const void*);
+        };
+
+        /**
+         * Action registry entry for an action and event type.
+         *
+         * @tparam Event the event type the action applies to
+         *
+         * @tparam action a static action function pointer
+         */
+        template<class Event, auto action>
+        static constexpr action_type action_for = {
+            Events::template index_of<Event>(), &invoke_action<Event, action>
+        };
+
+        /**
+         * Guard registry entry for a guard and event type.
+         *
+         * @tparam Event the event type the guard applies to
+         *
+         * @tparam guard a static guard function pointer
+         */
+        template<class Event, auto guard>
+        static constexpr guard_type guard_for = {
+            Events::template index_of<Event>(), &invoke_guard<Event, guard>
+        };
+
+    public:
+        /**
+         * Create an empty runtime transition table.
+         */
+        runtime_table() {
+            clear();
+        }
+
+        /**
+         * Remove all rows.
+         */
+        void clear() {
+            for (index_type& first : m_first) {
+                first = none;
+            }
+            m_size = 0;
+        }
+
+        /**
+         * Load transition table rows, replacing any existing rows.
+         *
+         * Rows are checked in the given order, as with compile-time
+         * transition tables.
+         *
+         * @param rows pointer to the rows to load
+         *
+         * @param n the number of rows to load
+         *
+         * @param actions the action registry
+         *
+         * @param nactions the number of registered actions
+         *
+         * @param guards the guard registry
+         *
+         * @param nguards the number of registered guards
+         *
+         * @return `false` if the rows exceed the table's capacity or
+         * refer to invalid states, events, actions or guards, in
+         * which case the table is left empty
+         */
+        bool load(const runtime_row* rows, std::size_t n,
+                  const action_type* actions = nullptr, std::size_t nactions = 0,
+                  const guard_type* guards = nullptr, std::size_t nguards = 0)
+        {
+            clear();
+            if (n > MaxRows) {
+                return false;
+            }
+            // link rows in reverse, so they are checked in given order
+            for (std::size_t i = n; i-- != 0;) {
+                const runtime_row& r = rows[i];
+                if (r.start >= MaxStates || r.target >= MaxStates || r.event >= events) {
+                    return fail();
+                }
+                if (r.action > nactions || (r.action && actions[r.action - 1].event != r.event)) {
+                    return fail();
+                }
+                if (r.guard > nguards || (r.guard && guards[r.guard - 1].event != r.event)) {
+                    return fail();
+                }
+                std::size_t cell = r.start * events + r.event;
+                entry& e = m_rows[i];
+                e.action = r.action ? actions[r.action - 1].invoke : nullptr;
+                e.guard = r.guard ? guards[r.guard - 1].invoke : nullptr;
+                e.target = r.target;
+                e.next = m_first[cell];
+                m_first[cell] = static_cast<index_type>(i);
+            }
+            m_size = n;
+            return true;
+        }
+
+        /**
+         * Return the number of rows.
+         */
+        std::size_t size() const { return m_size; }
+
+        /**
+         * Process an event.
+         *
+         * @param self the state machine
+         *
+         * @param state the current state, replaced by the target
+         * state if a transition was found
+         *
+         * @param event the event instance
+         *
+         * @return `false` if no transition was found
+         */
+        template<class State, class Event>
+        bool process_event(Derived& self, State& state, const Event& event) const {
+            constexpr std::size_t index = Events::template index_of<Event>();
+            static_assert(index != events, "event type not in runtime table event list");
+            std::size_t s = static_cast<std::size_t>(state);
+            if (s >= MaxStates) {
+                return false;
+            }
+            for (index_type i = m_first[s * events + index]; i != none; i = m_rows[i].next) {
+                const entry& e = m_rows[i];
+                if (!e.guard || e.guard(self, &event)) {
+                    if (e.action) {
+                        e.action(self, &event);
+                    }
+                    state = static_cast<State>(e.target);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        bool fail() {
+            clear();
+            return false;
+        }
+
+    private:
+        struct entry {
+            void (*action)(Derived&, const void*);
+            bool (*guard)(const Derived&, const void*);
+            unsigned short target;
+            index_type next;
+        };
+
+        alignas(64) index_type m_first[MaxStates * events ? MaxStates * events : 1];
+        alignas(64) entry m_rows[MaxRows ? MaxRows : 1];
+        std::size_t m_size;
+    };
+
+    namespace detail {
+        // ring buffer of previous states; member names are chosen to
+        // avoid clashes in derived state machine classes
+        template<class State, std::size_t N>
+        struct state_history {
+            State m_history[N];
+            std::size_t m_history_count = 0;
+            std::size_t m_history_size = 0;
+
+            void push_history(State state) {
+                m_history[m_history_count++ % N] = state;
+                m_history_size += m_history_size != N;
+            }
+
+            bool pop_history(std::size_t n, State& state) {
+                if (n > m_history_size) {
+                    return false;
+                } else if (n != 0) {
+                    m_history_count -= n;
+                    m_history_size -= n;
+                    state = m_history[m_history_count % N];
+                }
+                return true;
+            }
+        };
+
+        template<class State>
+        struct state_history<State, 0> {};
+    }
+
+    /**
+     * Guard log class.
+     *
+     * A guard log records the outcome of every guard evaluated by a
+     * state machine as a single bit in a caller-provided buffer, so
+     * a sequence of events can later be replayed with identical
+     * guard outcomes, without calling the guards.  Actions may also
+     * record nondeterministic inputs using `input()`.
+     *
+     * A state machine uses a guard log if it has a non-static data
+     * member `guard_log` of type `fsmlite::guard_log*`, and the
+     * member is not `nullptr`.  Only guards which are not evaluated
+     * at compile time are recorded.
+     */
+    class guard_log {
+    public:
+        /**
+         * Guard log modes.
+         */
+        enum mode_type {
+            /** Evaluate guards and record their outcomes. */
+            record,
+            /** Return recorded outcomes instead of evaluating guards. */
+            replay
+        };
+
+    public:
+        /**
+         * Create a guard log.
+         *
+         * @param buffer the buffer to record to or replay from
+         *
+         * @param size the size of the buffer in bytes
+         *
+         * @param mode the guard log mode
+         *
+         * @param bits the number of recorded bits to replay; ignored
+         * in `record` mode
+         */
+        guard_log(unsigned char* buffer, std::size_t size, mode_type mode, std::size_t bits = 0) noexcept
+            : m_buffer(buffer), m_size(8 * size), m_end(mode == record ? 0 : bits), m_pos(0), m_mode(mode), m_overflow(false)
+        {
+            if (m_end > m_size) {
+                m_end = m_size;
+            }
+        }
+
+        /**
+         * Return the guard log mode.
+         */
+        mode_type mode() const noexcept { return m_mode; }
+
+        /**
+         * Return the number of bits recorded or replayed so far.
+         */
+        std::size_t bits() const noexcept { return m_pos; }
+
+        /**
+         * Return whether the buffer was too small for recording, or
+         * replay ran past the end of the recorded bits.
+         */
+        bool overflow() const noexcept { return m_overflow; }
+
+        /**
+         * Record or replay the outcome of a guard.
+         *
+         * In `record` mode, the guard is evaluated and its outcome is
+         * appended to the log.  In `replay` mode, the next recorded
+         * outcome is returned; the guard is only evaluated if no
+         * recorded outcomes are left.
+         *
+         * @param guard a function object returning the guard's
+         * outcome
+         */
+        template<class Guard>
+        bool check(Guard&& guard) {
+            if (m_mode == replay) {
+                return m_pos < m_end ? read_bit() : (m_overflow = true, guard());
+            } else {
+                bool value = guard();
+                write_bit(value);
+                return value;
+            }
+        }
+
+        /**
+         * Record or replay a nondeterministic input value.
+         *
+         * @param read a function object returning the input value,
+         * which must be of a trivially copyable type; only called in
+         * `record` mode, or if replay has run out of recorded bits
+         *
+         * @return the recorded or replayed value
+         */
+        template<class Read>
+        auto input(Read&& read) {
+            using value_type = decltype(read());
+            static_assert(std::is_trivially_copyable<value_type>::value, "input must be trivially copyable");
+            if (m_mode == replay && m_pos + 8 * sizeof(value_type) > m_end) {
+                m_overflow = true;
+                return read();
+            }
+            value_type value = m_mode == record ? read() : value_type();
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(&value);
+            for (std::size_t i = 0; i != sizeof(value_type); ++i) {
+                for (unsigned bit = 0; bit != 8; ++bit) {
+                    if (m_mode == record) {
+                        write_bit((bytes[i] >> bit) & 1);
+                    } else {
+                        bytes[i] = static_cast<unsigned char>(bytes[i] | read_bit() << bit);
+                    }
+                }
+            }
+            return value;
+        }
+
+    private:
+        bool read_bit() noexcept {
+            bool value = (m_buffer[m_pos / 8] >> (m_pos % 8)) & 1;
+            ++m_pos;
+            return value;
+        }
+
+        void write_bit(bool value) noexcept {
+            if (m_pos == m_size) {
+                m_overflow = true;
+                return;
+            }
+            unsigned char& byte = m_buffer[m_pos / 8];
+            unsigned mask = 1u << (m_pos % 8);
+            byte = static_cast<unsigned char>(value ? byte | mask : byte & ~mask);
+            ++m_pos;
+        }
+
+    private:
+        unsigned char* m_buffer;
+        std::size_t m_size;
+        std::size_t m_end;
+        std::size_t m_pos;
+        mode_type m_mode;
+        bool m_overflow;
+    };
+
+    /**
+     * Finite state machine (FSM) base class template.
+     *
+     * @tparam Derived the derived state machine class
+     *
+     * @tparam State the FSM's state type, defaults to `int`
+     *
+     * @tparam HistorySize the number of previous states to keep for
+     * `rollback()`, defaults to zero
+     */
+    template<class Derived, class State = int, std::size_t HistorySize = 0>
+    class fsm : private detail::state_history<State, HistorySize> {
+        template<class...> struct by_char_class;
+        template<class...> struct byte_table;
+        template<class...> struct accepts_event;
+        template<class...> struct accepted_table;
+
+        template<class, std::size_t> friend class population;
+
+    public:
+        /**
+         * The FSM's state type.
+         */
+        typedef State state_type;
+
+    public:
+        /**
+         * Create a state machine with an optional initial state.
+         *
+         * @param init_state the FSM's initial state
+         */
+        fsm(state_type init_state = state_type()) : m_state(init_state) {}
+
+        /**
+         * Process an event.
+         *
+         * After the event has been processed, any completion
+         * transitions from the new state are executed.
+         *
+         * By default, the code for finding a matching transition is
+         * generated for each derived state machine and event type.
+         * Derived state machines that define a static constant data
+         * member `shared_dispatch` with value `true` instead use code
+         * that is only generated once per sequence of start states,
+         * and shared between all state machines and event types with
+         * the same table layout.  Guards and actions are then invoked
+         * through per-row function pointers, which trades some speed
+         * for less code.
+         *
+         * Derived state machines that define a static constant data
+         * member `hashed_dispatch` with value `true` look up the rows
+         * for the current state in a perfect hash table of start
+         * states generated at compile time, so the cost of finding a
+         * transition does not depend on the number of start states.
+         * This requires a `state_key` for the state type, and is
+         * ignored if `shared_dispatch` is also enabled.
+         *
+         * Derived state machines that define a static constant data
+         * member `collect_metrics` with value `true` count processed
+         * events, events without a matching transition and
+         * transitions per row, see `metrics_snapshot()`.
+         *
+         * @warning This member function must not be called
+         * recursively, e.g. from another `fsm` instance.
+         *
+         * @tparam Event the event type
+         *
+         * @param event the event instance
+         *
+         * @throw std::logic_error if a recursive invocation is
+         * detected
+         */
+        template<class Event>
+        void process_event(const Event& event) {
+            using rows = typename by_event_type<Event, typename Derived::transition_table>::type;
+            processing_lock lock(*this);
+            record_state();
+            static_assert(std::is_base_of<fsm, Derived>::value, "must derive from fsm");
+            Derived& self = static_cast<Derived&>(*this);
+            count_event<Event>(0);
+            if constexpr (has_shared_dispatch<Derived>::value) {
+                m_state = shared_dispatch<Event, rows>::execute(self, event, m_state);
+            } else if constexpr (has_hashed_dispatch<Derived>::value) {
+                m_state = hashed_dispatch<Event, rows>::execute(self, event, m_state);
+            } else {
+                m_state = handle_event<Event, rows>::execute(self, event, m_state);
+            }
+            complete(self);
+        }
+
+        /**
+         * Return the metrics collected for all instances of the
+         * derived state machine class.
+         *
+         * Counters are kept per thread in cache-line padded shards,
+         * and incremented using relaxed atomic operations.  Taking a
+         * snapshot merges the shards without stopping any threads
+         * processing events, so counters may be slightly out of sync
+         * with each other.
+         *
+         * @return a `metrics` instance
+         */
+        static auto metrics_snapshot() {
+            static_assert(has_metrics<Derived>::value, "collect_metrics is not enabled");
+            using storage = metrics_storage<>;
+            typename storage::snapshot_type snapshot = {};
+            for (const auto& shard : storage::shards) {
+                for (std::size_t i = 0; i != storage::events; ++i) {
+                    snapshot.events[i] += shard.counts[i].load(std::memory_order_relaxed);
+                    snapshot.no_transitions[i] += shard.counts[storage::events + i].load(std::memory_order_relaxed);
+                }
+                for (std::size_t i = 0; i != storage::rows; ++i) {
+                    snapshot.transitions[i] += shard.counts[2 * storage::events + i].load(std::memory_order_relaxed);
+                }
+            }
+            return snapshot;
+        }
+
+        /**
+         * Process an event stored in an `event_pool`.
+         *
+         * @tparam Event the event type
+         *
+         * @param handle a non-empty handle to the event instance
+         *
+         * @throw std::logic_error if a recursive invocation is
+         * detected
+         */
+        template<class Event>
+        void process_event(const event_handle<Event>& handle) {
+            process_event(*handle);
+        }
+
+        /**
+         * Process an event using a runtime transition table.
+         *
+         * The state machine's `transition_table` is not used.
+         *
+         * @warning This member function must not be called
+         * recursively, e.g. from another `fsm` instance.
+         *
+         * @tparam Table the `runtime_table` type
+         *
+         * @tparam Event the event type
+         *
+         * @param table the runtime transition table
+         *
+         * @param event the event instance
+         *
+         * @throw std::logic_error if a recursive invocation is
+         * detected
+         */
+        template<class Table, class Event>
+        void process_event(const Table& table, const Event& event) {
+            processing_lock lock(*this);
+            record_state();
+            Derived& self = static_cast<Derived&>(*this);
+            if (!table.process_event(self, m_state, event)) {
+                m_state = self.no_transition(event);
+            }
+        }
+
+        /**
+         * Process an event identified by its event ID.
+         *
+         * The event type is looked up among all event types in the
+         * transition table that have an `event_id`, as described for
+         * `event_list::process_event_id()`.
+         *
+         * @warning This member function must not be called
+         * recursively, e.g. from another `fsm` instance.
+         *
+         * @param id the ID of the event type
+         *
+         * @param data pointer to an event of the identified type
+         *
+         * @return `false` if no event type has the given ID
+         *
+         * @throw std::logic_error if a recursive invocation is
+         * detected
+         */
+        template<class Id>
+        bool process_event_id(Id id, const void* data) {
+            using events = typename by_event_id<typename Derived::transition_table>::type;
+            return events::process_event_id(static_cast<Derived&>(*this), id, data);
+        }
+
+        /**
+         * Process a sequence of characters.
+         *
+         * Characters are matched against all transition table rows
+         * whose event type is a character class, e.g. `chars`,
+         * `not_chars` or `char_range`.  These rows are compiled into
+         * a dense `[state][byte class]` transition table, so they
+         * must neither have actions nor guards, and their states
+         * must be small non-negative integral values.  For states
+         * that only leave their self-loop on a single character, the
+         * input is scanned using `memchr()`.
+         *
+         * If no row matches a character, `no_transition()` is called
+         * with the `char` as its event argument.
+         *
+         * @warning This member function must not be called
+         * recursively, e.g. from another `fsm` instance.
+         *
+         * @param s pointer to the characters to process
+         *
+         * @param n the number of characters to process
+         *
+         * @throw std::logic_error if a recursive invocation is
+         * detected
+         */
+        void process_bytes(const char* s, std::size_t n) {
+            using dfa = byte_table<typename by_char_class<typename Derived::transition_table>::type>;
+            processing_lock lock(*this);
+            record_state();
+            Derived& self = static_cast<Derived&>(*this);
+            const char* end = s + n;
+            std::size_t index = dfa::index_of(m_state);
+            while ((s = dfa::run(index, s, end)) != end) {
+                if (index != dfa::states) {
+                    m_state = static_cast<state_type>(index);
+                }
+                m_state = self.no_transition(*s++);
+                index = dfa::index_of(m_state);
+            }
+            if (index != dfa::states) {
+                m_state = static_cast<state_type>(index);
+            }
+        }
+
+        /**
+         * Mapping of start states to end states for a sequence of
+         * characters, as returned by `map_bytes()`.
+         *
+         * Mappings of adjacent chunks of input can be computed
+         * independently, e.g. on separate threads, and combined in
+         * input order using `then()`.
+         */
+        class byte_mapping {
+            using dfa = byte_table<typename by_char_class<typename Derived::transition_table>::type>;
+
+        public:
+            /**
+             * Create the identity mapping of an empty sequence.
+             */
+            byte_mapping() {
+                for (std::size_t i = 0; i <= dfa::states; ++i) {
+                    map[i] = static_cast<typename dfa::index_type>(i);
+                }
+            }
+
+            /**
+             * Return the mapping of this sequence followed by
+             * another one.
+             *
+             * @param next the mapping of the following sequence
+             */
+            byte_mapping then(const byte_mapping& next) const {
+                byte_mapping result;
+                for (std::size_t i = 0; i <= dfa::states; ++i) {
+                    result.map[i] = next.map[map[i]];
+                }
+                return result;
+            }
+
+            /**
+             * Map a start state to its end state.
+             *
+             * @param state the start state, replaced by the end state
+             *
+             * @return `false` if a character without a matching row
+             * was encountered, leaving `state` unchanged
+             */
+            bool apply(state_type& state) const {
+                std::size_t index = map[dfa::index_of(state)];
+                if (index == dfa::states) {
+                    return false;
+                }
+                state = static_cast<state_type>(index);
+                return true;
+            }
+
+        private:
+            friend class fsm;
+
+            typename dfa::index_type map[dfa::states + 1];
+        };
+
+        /**
+         * Compute the mapping of all start states to end states for
+         * a sequence of characters.
+         *
+         * This runs the sequence through the character class rows of
+         * the transition table once for every possible start state,
+         * without involving any state machine instance.
+         *
+         * @param s pointer to the characters to process
+         *
+         * @param n the number of characters to process
+         */
+        static byte_mapping map_bytes(const char* s, std::size_t n) {
+            using dfa = byte_table<typename by_char_class<typename Derived::transition_table>::type>;
+            byte_mapping result;
+            for (std::size_t i = 0; i != dfa::states; ++i) {
+                std::size_t index = i;
+                if (dfa::run(index, s, s + n) != s + n) {
+                    index = dfa::states;
+                }
+                result.map[i] = static_cast<typename dfa::index_type>(index);
+            }
+            return result;
+        }
+
+        /**
+         * Process a sequence of characters given its state mapping.
+         *
+         * @param mapping the mapping returned by `map_bytes()`
+         *
+         * @return `false` if no state change occurred because the
+         * sequence contained a character without a matching row, in
+         * which case the sequence should be processed using
+         * `process_bytes()` to call `no_transition()`
+         */
+        bool process_bytes(const byte_mapping& mapping) {
+            processing_lock lock(*this);
+            record_state();
+            return mapping.apply(m_state);
+        }
+
+        /**
+         * Return the state machine's current state.
+         */
+        state_type current_state() const { return m_state; }
+
+        /**
+         * Return whether the transition table has any row for an
+         * event type and start state, regardless of guards.
+         *
+         * @tparam Event the event type
+         *
+         * @param state the start state
+         */
+        template<class Event>
+        static constexpr bool accepts(state_type state) {
+            return accepts_event<typename by_event_type<Event, typename Derived::transition_table>::type>::test(state);
+        }
+
+        /**
+         * Return the set of event types the transition table has any
+         * rows for in a start state, regardless of guards.
+         *
+         * The result is an `event_set` of all event types in the
+         * transition table.  For integral and enumeration state
+         * types, the sets are precomputed for every start state and
+         * looked up in constant time.
+         *
+         * @param state the start state
+         */
+        static auto accepted_events(state_type state) {
+            return accepted_table<typename Derived::transition_table>::find(state);
+        }
+
+        /**
+         * Bring the derived state machine's dispatch tables into
+         * memory and the data cache.
+         *
+         * All dispatch tables are `constexpr` objects generated at
+         * compile time, which are placed in read-only data and need
+         * no dynamic initialization.  Calling this function before
+         * the first event arrives avoids page faults and cache
+         * misses on the first dispatch, e.g. at service startup.
+         *
+         * @return the total size of the tables in bytes
+         */
+        static std::size_t warm() noexcept {
+            return detail::apply<warm_tables, typename Derived::transition_table>::type::touch();
+        }
+
+        /**
+         * Write the transition table as a Graphviz DOT graph.
+         *
+         * States are written as numbers, and events by their
+         * `event_name`, or their zero-based index in order of first
+         * appearance prefixed with `#` if they have no name.  Edge
+         * labels mark rows with an action by a trailing `/`, and rows
+         * with a guard by a trailing `[]`.
+         *
+         * @tparam Writer a function object type callable with a
+         * null-terminated `const char*` string
+         *
+         * @param out the writer receiving the output
+         */
+        template<class Writer>
+        static void write_dot(Writer& out) {
+            write_graph(out, false, nullptr);
+        }
+
+        /**
+         * Write the transition table as a Graphviz DOT graph with
+         * edges weighted by the number of transitions.
+         *
+         * @tparam Writer a function object type callable with a
+         * null-terminated `const char*` string
+         *
+         * @tparam Metrics a `metrics` type
+         *
+         * @param out the writer receiving the output
+         *
+         * @param snapshot the result of `metrics_snapshot()`
+         */
+        template<class Writer, class Metrics>
+        static void write_dot(Writer& out, const Metrics& snapshot) {
+            write_graph(out, false, snapshot.transitions);
+        }
+
+        /**
+         * Write the transition table as JSON.
+         *
+         * The output is an object with a `states` array of all start
+         * and target states in order of appearance, and a `rows`
+         * array of objects with members `start`, `event`, `target`,
+         * `action` and `guard`.
+         *
+         * @tparam Writer a function object type callable with a
+         * null-terminated `const char*` string
+         *
+         * @param out the writer receiving the output
+         */
+        template<class Writer>
+        static void write_json(Writer& out) {
+            write_graph(out, true, nullptr);
+        }
+
+        /**
+         * Write the transition table as JSON, with an additional
+         * `transitions` member for each row giving the number of
+         * transitions.
+         *
+         * @tparam Writer a function object type callable with a
+         * null-terminated `const char*` string
+         *
+         * @tparam Metrics a `metrics` type
+         *
+         * @param out the writer receiving the output
+         *
+         * @param snapshot the result of `metrics_snapshot()`
+         */
+        template<class Writer, class Metrics>
+        static void write_json(Writer& out, const Metrics& snapshot) {
+            write_graph(out, true, snapshot.transitions);
+        }
+
+        /**
+         * Checkpoint type returned by `checkpoint()`.
+         */
+        typedef unsigned long long checkpoint_type;
+
+        /**
+         * Return the number of processed events that can be rolled
+         * back, which is at most `HistorySize`.
+         */
+        std::size_t history_size() const {
+            if constexpr (HistorySize != 0) {
+                return this->m_history_size;
+            } else {
+                return 0;
+            }
+        }
+
+        /**
+         * Restore the state before the last `n` processed events.
+         *
+         * Only the state machine's state is restored; derived state
+         * machines are responsible for reverting any other changes
+         * made by actions.
+         *
+         * @warning This member function must not be called while
+         * processing an event.
+         *
+         * @param n the number of events to roll back
+         *
+         * @return `false` if `n` exceeds `history_size()`, in which
+         * case the state is not changed
+         *
+         * @throw std::logic_error if called while processing an
+         * event
+         */
+        bool rollback(std::size_t n = 1) {
+            processing_lock lock(*this);
+            if constexpr (HistorySize != 0) {
+                return this->pop_history(n, m_state);
+            } else {
+                return n == 0;
+            }
+        }
+
+        /**
+         * Return a checkpoint for the current state, which can be
+         * restored using `restore()` as long as no more than
+         * `HistorySize` events have been processed since.  Rolling
+         * back past a checkpoint invalidates it.
+         */
+        checkpoint_type checkpoint() const {
+            if constexpr (HistorySize != 0) {
+                return this->m_history_count;
+            } else {
+                return 0;
+            }
+        }
+
+        /**
+         * Restore the state at a checkpoint.
+         *
+         * @warning This member function must not be called while
+         * processing an event.
+         *
+         * @param cp the checkpoint returned by `checkpoint()`
+         *
+         * @return `false` if the checkpoint is no longer available,
+         * in which case the state is not changed
+         *
+         * @throw std::logic_error if called while processing an
+         * event
+         */
+        bool restore(checkpoint_type cp) {
+            checkpoint_type now = checkpoint();
+            return cp <= now && rollback(static_cast<std::size_t>(now - cp));
+        }
+
+    protected:
+        /**
+         * Called when no transition can be found for the given event
+         * in the current state.  Derived state machines may override
+         * this to throw an exception, or change to some other (error)
+         * state.  The default is to return the current state, so no
+         * state change occurs.
+         *
+         * @tparam Event the event type
+         *
+         * @param event the event instance
+         *
+         * @return the FSM's new state
+         */
+        template<class Event>
+        state_type no_transition(const Event& /*event*/) {
+            return m_state;
+        }
+
+    private:
+        template<State start, class Event, State target>
+        struct row_base {
+            using state_type = State;
+            using event_type = Event;
+
+            static constexpr state_type start_value() { return start; }
+            static constexpr state_type target_value() { return target; }
+
+        protected:
+            template<class Action>
+            static void process_event(Action&& action, Derived& self, const Event& event) {
+                detail::invoke_as_binary_fn(action, self, event);
+            }
+
+            // clang++-5.0: constexpr function's return type 'void' is not a literal type
+            static /*constexpr*/ void process_event(std::nullptr_t, Derived& /*self*/, const Event& /*event*/) {
+            }
+
+            template<class Guard>
+            static bool check_guard(Guard&& guard, const Derived& self, const Event& event) {
+                return detail::invoke_as_binary_fn(guard, self, event);
+            }
+
+            static constexpr bool check_guard(std::nullptr_t, const Derived&, const Event&) {
+                return true;
+            }
+
+            static constexpr bool check_guard(bool guard, const Derived&, const Event&) {
+                return guard;
+            }
+        };
+
+    protected:
+        /**
+         * Transition table variadic class template.
+         *
+         * Each derived state machine class must define a nested
+         * non-template type `transition_table` that's either derived
+         * from or a type alias of `table`.
+         */
+        template<class... Rows> using table = detail::list<Rows...>;
+
+        /**
+         * Basic transition class template.
+         *
+         * @tparam start the start state of the transition
+         *
+         * @tparam Event the event type triggering the transition
+         *
+         * @tparam target the target state of the transition
+         *
+         * @tparam Action an action function type, or `std::nullptr_t`
+         *
+         * @tparam action a static `Action` instance
+         *
+         * @tparam Guard a guard function type, `bool` or `std::nullptr_t`
+         *
+         * @tparam guard a static `Guard` instance; constant `bool`
+         * guards are evaluated at compile time
+         */
+        template<
+            State start,
+            class Event,
+            State target,
+            class Action = std::nullptr_t,
+            Action action = nullptr,
+            class Guard = std::nullptr_t,
+            Guard guard = nullptr
+        >
+        struct basic_row : public row_base<start, Event, target> {
+            static constexpr bool has_action() { return !std::is_null_pointer<Action>::value; }
+            static constexpr bool has_guard() { return !std::is_null_pointer<Guard>::value; }
+
+            using guard_type = detail::value_tag<Guard, guard>;
+
+            static void process_event(Derived& self, const Event& event) {
+                row_base<start, Event, target>::process_event(action, self, event);
+            }
+
+            static bool check_guard(const Derived& self, const Event& event) {
+                return row_base<start, Event, target>::check_guard(guard, self, event);
+            }
+        };
+
+        /**
+         * Member function transition class template.
+         *
+         * @tparam start the start state of the transition
+         *
+         * @tparam Event the event type triggering the transition
+         *
+         * @tparam target the target state of the transition
+         *
+         * @tparam action an action member function, or `nullptr`
+         *
+         * @tparam guard a guard member function, or `nullptr`
+         *
+         * @deprecated since version 1.0
+         */
+        template<
+            State start,
+            class Event,
+            State target,
+            void (Derived::*action)(const Event&) = nullptr,
+            bool (Derived::*guard)(const Event&) const = nullptr
+        >
+        struct mem_fn_row : public row_base<start, Event, target> {
+            static constexpr bool has_action() { return action != nullptr; }
+            static constexpr bool has_guard() { return guard != nullptr; }
+
+            using guard_type = detail::value_tag<decltype(guard), guard>;
+
+            static void process_event(Derived& self, const Event& event) {
+                if (action != nullptr) {
+                    row_base<start, Event, target>::process_event(action, self, event);
+                }
+            }
+
+            static bool check_guard(const Derived& self, const Event& event) {
+                if (guard != nullptr) {
+                    return row_base<start, Event, target>::check_guard(guard, self, event);
+                } else {
+                    return true;
+                }
+            }
+        };
+
+        /**
+         * Generic transition class template.
+         *
+         * @tparam start the start state of the transition
+         *
+         * @tparam Event the event type triggering the transition
+         *
+         * @tparam target the target state of the transition
+         *
+         * @tparam action a static action function pointer, or `nullptr`
+         *
+         * @tparam guard a static guard function pointer, a pointer
+         * to a data member of the derived class converted to `bool`
+         * (a column guard), a constant `bool` value evaluated at
+         * compile time, or `nullptr`
+         */
+        template<
+            State start,
+            class Event,
+            State target,
+            auto action = nullptr,
+            auto guard = nullptr
+        >
+        struct row : public row_base<start, Event, target> {
+            static constexpr bool has_action() { return !std::is_null_pointer<decltype(action)>::value; }
+            static constexpr bool has_guard() { return !std::is_null_pointer<decltype(guard)>::value; }
+
+            using guard_type = detail::value_tag<decltype(guard), guard>;
+
+            static void process_event(Derived& self, const Event& event) {
+                row_base<start, Event, target>::process_event(action, self, event);
+            }
+
+            static bool check_guard(const Derived& self, const Event& event) {
+                return row_base<start, Event, target>::check_guard(guard, self, event);
+            }
+        };
+
+        /**
+         * Transactional transition class template.
+         *
+         * If the action exits via an exception, the compensating
+         * action is invoked to undo any partial side effects, and the
+         * state machine changes to the error state instead of the
+         * target state.  The exception is not propagated, but an
+         * exception thrown by the compensating action is.  If
+         * exceptions are disabled, this behaves like a regular `row`.
+         *
+         * @tparam start the start state of the transition
+         *
+         * @tparam Event the event type triggering the transition
+         *
+         * @tparam target the target state of the transition
+         *
+         * @tparam action a static action function pointer
+         *
+         * @tparam compensation a static compensating action function
+         * pointer
+         *
+         * @tparam error the target state if the action fails
+         *
+         * @tparam guard a static guard function pointer, or `nullptr`
+         */
+        template<
+            State start,
+            class Event,
+            State target,
+            auto action,
+            auto compensation,
+            State error,
+            auto guard = nullptr
+        >
+        struct transaction_row : public row_base<start, Event, target> {
+            static constexpr bool has_action() { return true; }
+            static constexpr bool has_guard() { return !std::is_null_pointer<decltype(guard)>::value; }
+
+            using guard_type = detail::value_tag<decltype(guard), guard>;
+
+            static constexpr State error_value() { return error; }
+
+            static void process_event(Derived& self, const Event& event) {
+                row_base<start, Event, target>::process_event(action, self, event);
+            }
+
+            static bool check_guard(const Derived& self, const Event& event) {
+                return row_base<start, Event, target>::check_guard(guard, self, event);
+            }
+
+            static State transition(Derived& self, const Event& event) {
+#if !__GNUC__ || __EXCEPTIONS
+                try {
+                    process_event(self, event);
+                } catch (...) {
+                    row_base<start, Event, target>::process_event(compensation, self, event);
+                    return error;
+                }
+#else
+                process_event(self, event);
+#endif
+                return target;
+            }
+        };
+
+    private:
+        template<class T, class = void>
+        struct has_guard_log : std::false_type {};
+
+        template<class T>
+        struct has_guard_log<T, std::void_t<decltype(static_cast<T*>(nullptr)->guard_log)>> : std::true_type {};
+
+        template<class T, class Event>
+        static bool guard_holds(const Derived& self, const Event& event) {
+            if constexpr (has_guard_log<Derived>::value && detail::guard_constant(typename T::guard_type()) < 0) {
+                if (guard_log* log = self.guard_log) {
+                    return log->check([&self, &event]() -> bool { return T::check_guard(self, event); });
+                }
+            }
+            return T::check_guard(self, event);
+        }
+
+        template<class T, class Event>
+        static State transition(Derived& self, const Event& event) {
+            count_transition<T>();
+            if constexpr (detail::has_transition<T>::value) {
+                return T::transition(self, event);
+            } else {
+                T::process_event(self, event);
+                return T::target_value();
+            }
+        }
+
+        template<class T, T guard>
+        static constexpr bool is_pure(detail::value_tag<T, guard>) {
+            if constexpr (std::is_pointer<T>::value || std::is_member_pointer<T>::value) {
+                return is_pure_guard<guard>::value;
+            } else {
+                return false;
+            }
+        }
+
+        // whether row R can never fire because of a preceding row P
+        template<class P, class R>
+        static constexpr bool shadows() {
+            using guard = typename P::guard_type;
+            return P::start_value() == R::start_value() && (
+                detail::guard_constant(guard()) == 1 ||
+                (std::is_same<guard, typename R::guard_type>::value && is_pure(guard()))
+            );
+        }
+
+        // remove rows that can never fire from a list of rows
+        template<class...> struct prune_rows;
+
+        template<class... Done>
+        struct prune_rows<detail::list<Done...>, detail::list<>> {
+            using type = detail::list<Done...>;
+        };
+
+        template<class... Done, class T, class... Types>
+        struct prune_rows<detail::list<Done...>, detail::list<T, Types...>> {
+            static constexpr bool dead = detail::guard_constant(typename T::guard_type()) == 0 || (shadows<Done, T>() || ...);
+            using type = typename prune_rows<
+                typename std::conditional<dead, detail::list<Done...>, detail::list<Done..., T>>::type,
+                detail::list<Types...>
+            >::type;
+        };
+
+        template<class Event, class...> struct by_event_type;
+
+        template<class Event, class... Types>
+        struct by_event_type<Event, detail::list<Types...>> {
+            template<class T> using predicate = std::is_same<typename T::event_type, Event>;
+            using type = typename prune_rows<
+                detail::list<>, typename detail::filter<predicate, Types...>::type
+            >::type;
+        };
+
+        template<class Event>
+        struct by_event_type<Event, detail::list<>> {
+            using type = detail::list<>;
+        };
+
+        template<class...> struct by_event_id;
+
+        template<class... Types>
+        struct by_event_id<detail::list<Types...>> {
+            template<class T> using predicate = detail::has_event_id<T>;
+            template<class... Events> using filter = detail::filter<predicate, Events...>;
+            using events = typename detail::unique<detail::list<>, typename Types::event_type...>::type;
+            using type = typename detail::apply<
+                event_list, typename detail::apply<filter, events>::type::type
+            >::type;
+        };
+
+        template<class... Rows>
+        struct accepts_event<detail::list<Rows...>> {
+            static constexpr bool test(State state) {
+                return ((state == Rows::start_value()) || ...);
+            }
+        };
+
+        template<class... Rows>
+        struct accepted_table<detail::list<Rows...>> {
+            template<class T> using predicate = std::negation<std::is_same<T, completion>>;
+            template<class... Events> using filter = detail::filter<predicate, Events...>;
+            using events = typename detail::apply<filter, typename detail::unique<
+                detail::list<>, typename Rows::event_type...
+            >::type>::type::type;
+            using set_type = event_set<typename detail::apply<event_list, events>::type>;
+            using starts = typename detail::unique<detail::list<>, detail::value_tag<State, Rows::start_value()>...>::type;
+
+            static constexpr set_type make_set(State state) {
+                set_type set;
+                ((state == Rows::start_value() && detail::guard_constant(typename Rows::guard_type()) != 0 ?
+                  set.set(set_type::event_types::template index_of<typename Rows::event_type>()) : set), ...);
+                return set;
+            }
+
+            template<class> struct lookup;
+
+            template<State... Starts>
+            struct lookup<detail::list<detail::value_tag<State, Starts>...>> {
+                using keys = detail::key_table<static_cast<unsigned long long>(Starts)...>;
+                static constexpr set_type sets[] = { make_set(Starts)... };
+
+                static set_type find(State state) {
+                    std::size_t index = keys::find(static_cast<unsigned long long>(state));
+                    return index < keys::size ? sets[index] : set_type();
+                }
+            };
+
+            static set_type find(State state) {
+                if constexpr ((std::is_integral<State>::value || std::is_enum<State>::value) && sizeof...(Rows) != 0) {
+                    return lookup<starts>::find(state);
+                } else {
+                    return make_set(state);
+                }
+            }
+        };
+
+        using column_mask_type = void (*)(const Derived* const*, std::size_t, bool*);
+
+        // evaluates the guards of the rows for an event from a start
+        // state over a batch of instances, if all are column guards
+        template<class Event, State start>
+        struct column_mask {
+            template<class T> using predicate = std::integral_constant<bool, T::start_value() == start>;
+            template<class... Rows> using from_start = detail::filter<predicate, Rows...>;
+            using rows = typename detail::apply<
+                from_start, typename by_event_type<Event, typename Derived::transition_table>::type
+            >::type::type;
+
+            template<class> struct batch;
+
+            template<class... Rows>
+            struct batch<detail::list<Rows...>> {
+                static constexpr bool enabled =
+                    sizeof...(Rows) != 0 && (detail::is_column_guard<typename Rows::guard_type>::value && ...);
+
+                template<class T>
+                static void apply(const Derived* const* instances, std::size_t n, bool* mask) {
+                    constexpr auto field = detail::tag_value(typename T::guard_type());
+                    for (std::size_t i = 0; i != n; ++i) {
+                        mask[i] = mask[i] | static_cast<bool>(instances[i]->*field);
+                    }
+                }
+
+                static void evaluate(const Derived* const* instances, std::size_t n, bool* mask) {
+                    for (std::size_t i = 0; i != n; ++i) {
+                        mask[i] = false;
+                    }
+                    (apply<Rows>(instances, n, mask), ...);
+                }
+            };
+
+            static constexpr column_mask_type get() {
+                if constexpr (batch<rows>::enabled) {
+                    return &batch<rows>::evaluate;
+                } else {
+                    return nullptr;
+                }
+            }
+        };
+
+        // the distinct start states of a transition table
+        template<class... Rows>
+        struct start_states {
+            template<class> struct lookup;
+
+            template<State... Starts>
+            struct lookup<detail::list<detail::value_tag<State, Starts>...>> {
+                using keys = detail::key_table<static_cast<unsigned long long>(Starts)...>;
+                static constexpr std::size_t size = sizeof...(Starts);
+                static constexpr State values[] = { Starts... };
+
+                template<class Event>
+                static constexpr column_mask_type column_masks[] = { column_mask<Event, Starts>::get()... };
+            };
+
+            using type = lookup<typename detail::unique<
+                detail::list<>, detail::value_tag<State, Rows::start_value()>...
+            >::type>;
+        };
+
+        template<class Self = Derived>
+        using start_state_table = typename detail::apply<start_states, typename Self::transition_table>::type::type;
+
+        template<class... Rows>
+        struct warm_tables {
+            // character classes are dispatched by the byte table
+            template<class T> using predicate = std::negation<std::disjunction<
+                std::is_same<T, completion>, detail::is_char_class<T>
+            >>;
+            using events = typename detail::filter<
+                predicate, typename Rows::event_type...
+            >::type;
+
+            template<class Event>
+            static std::size_t touch_event() noexcept {
+                using rows = typename by_event_type<Event, detail::list<Rows...>>::type;
+                if constexpr (has_shared_dispatch<Derived>::value) {
+                    using dispatch = shared_dispatch<Event, rows>;
+                    return detail::touch(dispatch::thunks, sizeof(dispatch::thunks)) +
+                        detail::touch(dispatch::targets, sizeof(dispatch::targets));
+                } else if constexpr (has_hashed_dispatch<Derived>::value) {
+                    using dispatch = hashed_dispatch<Event, rows>;
+                    using states = typename dispatch::template lookup<typename dispatch::starts>;
+                    return detail::touch(&states::keys::table, sizeof(states::keys::table)) +
+                        detail::touch(states::handlers, sizeof(states::handlers));
+                } else {
+                    return 0;
+                }
+            }
+
+            template<class> struct touch_events;
+
+            template<class... Events>
+            struct touch_events<detail::list<Events...>> {
+                static std::size_t touch() noexcept {
+                    // touch each event type's tables only once
+                    using unique = typename detail::unique<detail::list<>, Events...>::type;
+                    return touch_unique(unique());
+                }
+
+                template<class... Unique>
+                static std::size_t touch_unique(detail::list<Unique...>) noexcept {
+                    return (std::size_t(0) + ... + touch_event<Unique>());
+                }
+            };
+
+            static std::size_t touch() noexcept {
+                std::size_t size = touch_events<events>::touch();
+                if constexpr ((std::is_integral<State>::value || std::is_enum<State>::value) && sizeof...(Rows) != 0) {
+                    using accepted = accepted_table<detail::list<Rows...>>;
+                    using lookup = typename accepted::template lookup<typename accepted::starts>;
+                    size += detail::touch(&lookup::keys::table, sizeof(lookup::keys::table));
+                    size += detail::touch(lookup::sets, sizeof(lookup::sets));
+                }
+                using char_rows = typename by_char_class<detail::list<Rows...>>::type;
+                if constexpr (!std::is_same<char_rows, detail::list<>>::value) {
+                    using dfa = byte_table<char_rows>;
+                    size += detail::touch(&dfa::table, sizeof(dfa::table));
+                }
+                return size;
+            }
+        };
+
+        template<class... Types>
+        struct by_char_class<detail::list<Types...>> {
+            template<class T> using predicate = detail::is_char_class<typename T::event_type>;
+            using type = typename detail::filter<predicate, Types...>::type;
+        };
+
+        template<class... Rows>
+        struct byte_table<detail::list<Rows...>> {
+            static_assert(sizeof...(Rows) != 0, "no character class rows in transition table");
+            static_assert(((!Rows::has_action() && !Rows::has_guard()) && ...),
+                          "character class rows must not have actions or guards");
+            static_assert(std::is_integral<State>::value || std::is_enum<State>::value,
+                          "character class rows require an integral or enumeration state type");
+
+            struct info {
+                std::size_t start;
+                std::size_t target;
+                bool (*contains)(unsigned char);
+            };
+
+            static constexpr info rows[] = {
+                { static_cast<std::size_t>(Rows::start_value()),
+                  static_cast<std::size_t>(Rows::target_value()),
+                  &Rows::event_type::contains }...
+            };
+
+            static constexpr std::size_t count_states() {
+                std::size_t n = 0;
+                for (const info& r : rows) {
+                    n = r.start >= n ? r.start + 1 : n;
+                    n = r.target >= n ? r.target + 1 : n;
+                }
+                return n;
+            }
+
+            // number of valid states; also used as the "no transition" marker
+            static constexpr std::size_t states = count_states();
+
+            static_assert(states < 0xffff, "character class rows require small non-negative states");
+
+            using index_type = detail::uint_for<states>;
+
+            static constexpr std::size_t target_of(std::size_t state, unsigned char c) {
+                for (const info& r : rows) {
+                    if (r.start == state && r.contains(c)) {
+                        return r.target;
+                    }
+                }
+                return states;
+            }
+
+            static constexpr bool same_class(unsigned char a, unsigned char b) {
+                for (std::size_t s = 0; s != states; ++s) {
+                    if (target_of(s, a) != target_of(s, b)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            struct class_map {
+                unsigned char class_of[256] = {};
+                unsigned char first[256] = {};
+                std::size_t size = 0;
+            };
+
+            static constexpr class_map make_class_map() {
+                class_map m;
+                for (std::size_t c = 0; c != 256; ++c) {
+                    std::size_t k = 0;
+                    while (k != m.size && !same_class(m.first[k], static_cast<unsigned char>(c))) {
+                        ++k;
+                    }
+                    if (k == m.size) {
+                        m.first[m.size++] = static_cast<unsigned char>(c);
+                    }
+                    m.class_of[c] = static_cast<unsigned char>(k);
+                }
+                return m;
+            }
+
+            static constexpr class_map classes_map = make_class_map();
+
+            // number of byte equivalence classes
+            static constexpr std::size_t classes = classes_map.size;
+
+            // the extra state row handles states outside the table
+            struct table_type {
+                unsigned char class_of[256] = {};
+                index_type next[(states + 1) * classes] = {};
+                unsigned short skip[states + 1] = {};
+            };
+
+            // marks states without a single-character self-loop exit
+            static constexpr unsigned short no_skip = 0x100;
+
+            static constexpr table_type make_table() {
+                table_type t;
+                for (std::size_t c = 0; c != 256; ++c) {
+                    t.class_of[c] = classes_map.class_of[c];
+                }
+                for (std::size_t s = 0; s <= states; ++s) {
+                    std::size_t exits = 0;
+                    unsigned short exit = no_skip;
+                    for (std::size_t k = 0; k != classes; ++k) {
+                        t.next[s * classes + k] = static_cast<index_type>(s == states ? states : target_of(s, classes_map.first[k]));
+                    }
+                    for (std::size_t c = 0; c != 256; ++c) {
+                        if (t.next[s * classes + t.class_of[c]] != s) {
+                            exit = static_cast<unsigned short>(c);
+                            ++exits;
+                        }
+                    }
+                    t.skip[s] = exits == 1 ? exit : no_skip;
+                }
+                return t;
+            }
+
+            static constexpr table_type table = make_table();
+            static constexpr const unsigned char* class_of = table.class_of;
+            static constexpr const index_type* next = table.next;
+            static constexpr const unsigned short* skip = table.skip;
+
+            static std::size_t index_of(State state) {
+                std::size_t index = static_cast<std::size_t>(state);
+                return index < states ? index : states;
+            }
+
+            // run until the end of input or a character without a
+            // matching row, which is returned
+            static const char* run(std::size_t& index, const char* s, const char* end) {
+                std::size_t i = index;
+                while (s != end) {
+                    if (skip[i] != no_skip) {
+                        s = detail::find_char(s, end, static_cast<char>(skip[i]));
+                        if (s == end) {
+                            break;
+                        }
+                    }
+                    std::size_t n = next[i * classes + class_of[static_cast<unsigned char>(*s)]];
+                    if (n == states) {
+                        break;
+                    }
+                    i = n;
+                    ++s;
+                }
+                index = i;
+                return s;
+            }
+        };
+
+        template<class Event, class...> struct handle_event;
+
+        template<class Event, class T, class... Types>
+        struct handle_event<Event, detail::list<T, Types...>> {
+            static State execute(Derived& self, const Event& event, State state) {
+                return state == T::start_value() && guard_holds<T>(self, event) ?
+                    transition<T>(self, event) :
+                    handle_event<Event, detail::list<Types...>>::execute(self, event, state);
+            }
+        };
+
+        template<class Event>
+        struct handle_event<Event, detail::list<>> {
+            static State execute(Derived& self, const Event& event, State) {
+                return reject(self, event);
+            }
+        };
+
+        template<class T, class = void>
+        struct has_shared_dispatch : std::false_type {};
+
+        template<class T>
+        struct has_shared_dispatch<T, std::void_t<decltype(T::shared_dispatch)>>
+            : std::integral_constant<bool, T::shared_dispatch> {};
+
+        template<class Event, class...> struct shared_dispatch;
+
+        template<class Event, class... Rows>
+        struct shared_dispatch<Event, detail::list<Rows...>> {
+            using selector_state = typename detail::selector_state<State>::type;
+            using selector = detail::row_selector<selector_state, static_cast<selector_state>(Rows::start_value())...>;
+
+            template<class T>
+            static bool guard(const void* self, const void* event) {
+                return guard_holds<T>(*static_cast<const Derived*>(self), *static_cast<const Event*>(event));
+            }
+
+            template<class T>
+            static void process(void* self, const void* event, void* state) {
+                *static_cast<State*>(state) = fsm::transition<T>(*static_cast<Derived*>(self), *static_cast<const Event*>(event));
+            }
+
+            template<class T>
+            static constexpr detail::row_thunks thunks_for() {
+                return {
+                    T::has_guard() ? &guard<T> : nullptr,
+                    T::has_action() || detail::has_transition<T>::value || has_metrics<Derived>::value ?
+                        &process<T> : nullptr
+                };
+            }
+
+            static constexpr detail::row_thunks thunks[sizeof...(Rows) + 1] = { thunks_for<Rows>()..., { nullptr, nullptr } };
+            static constexpr State targets[sizeof...(Rows) + 1] = { Rows::target_value()..., State() };
+
+            static State execute(Derived& self, const Event& event, State state) {
+                std::size_t index = selector::select(static_cast<selector_state>(state), thunks, &self, &event);
+                if (index == sizeof...(Rows)) {
+                    return reject(self, event);
+                } else if (thunks[index].transition) {
+                    thunks[index].transition(&self, &event, &state);
+                    return state;
+                } else {
+                    return targets[index];
+                }
+            }
+        };
+
+        template<class T, class = void>
+        struct has_hashed_dispatch : std::false_type {};
+
+        template<class T>
+        struct has_hashed_dispatch<T, std::void_t<decltype(T::hashed_dispatch)>>
+            : std::integral_constant<bool, T::hashed_dispatch> {};
+
+        template<class Event, class...> struct hashed_dispatch;
+
+        template<class Event, class... Rows>
+        struct hashed_dispatch<Event, detail::list<Rows...>> {
+            using handler = State (*)(Derived&, const Event&, State);
+
+            template<State start>
+            struct from {
+                template<class T> using predicate = std::integral_constant<bool, T::start_value() == start>;
+                using rows = typename detail::filter<predicate, Rows...>::type;
+            };
+
+            template<class> struct lookup;
+
+            // rows with the same start state keep their relative order
+            template<State... Starts>
+            struct lookup<detail::list<detail::value_tag<State, Starts>...>> {
+                using keys = detail::key_table<state_key<State>::get(Starts)...>;
+                static constexpr handler handlers[] = { &handle_event<Event, typename from<Starts>::rows>::execute... };
+            };
+
+            using starts = typename detail::unique<detail::list<>, detail::value_tag<State, Rows::start_value()>...>::type;
+
+            static State execute(Derived& self, const Event& event, State state) {
+                if constexpr (sizeof...(Rows) != 0) {
+                    using states = lookup<starts>;
+                    std::size_t index = states::keys::find(state_key<State>::get(state));
+                    return index < states::keys::size ? states::handlers[index](self, event, state) : reject(self, event);
+                } else {
+                    return reject(self, event);
+                }
+            }
+        };
+
+        template<class T, class = void>
+        struct has_metrics : std::false_type {};
+
+        template<class T>
+        struct has_metrics<T, std::void_t<decltype(T::collect_metrics)>>
+            : std::integral_constant<bool, T::collect_metrics> {};
+
+        template<class... Rows>
+        struct metrics_types {
+            using events = typename detail::unique<detail::list<>, typename Rows::event_type...>::type;
+            using type = metrics<typename detail::apply<event_list, events>::type, sizeof...(Rows)>;
+        };
+
+        // counters of this state machine class; a template, so it is
+        // only instantiated once the transition table is complete
+        template<class Self = Derived>
+        struct metrics_storage {
+            using snapshot_type = typename detail::apply<metrics_types, typename Self::transition_table>::type::type;
+            using event_types = typename snapshot_type::event_types;
+
+            static constexpr std::size_t events = event_types::size();
+            static constexpr std::size_t rows = sizeof(snapshot_type::transitions) / sizeof(unsigned long) - 1;
+
+            struct alignas(64) shard {
+                std::atomic<unsigned long> counts[2 * events + rows];
+            };
+
+            static inline shard shards[detail::metrics_shards];
+
+            static void increment(std::size_t index) noexcept {
+                shards[detail::metrics_shard()].counts[index].fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        // count an event; kind 0 is processed, 1 is no transition
+        template<class Event>
+        static void count_event(std::size_t kind) noexcept {
+            if constexpr (has_metrics<Derived>::value) {
+                using storage = metrics_storage<>;
+                constexpr std::size_t index = storage::event_types::template index_of<Event>();
+                if constexpr (index != storage::events) {
+                    storage::increment(kind * storage::events + index);
+                }
+            }
+        }
+
+        template<class T>
+        static void count_transition() noexcept {
+            if constexpr (has_metrics<Derived>::value) {
+                using storage = metrics_storage<>;
+                constexpr std::size_t index = detail::index_of<T, typename Derived::transition_table>::value;
+                if constexpr (index != storage::rows) {
+                    storage::increment(2 * storage::events + index);
+                }
+            }
+        }
+
+        template<class... Rows>
+        struct graph_writer {
+            using events = typename detail::apply<
+                event_list, typename detail::unique<detail::list<>, typename Rows::event_type...>::type
+            >::type;
+
+            template<class Writer>
+            static void write(Writer& out, bool json, const unsigned long* counts) {
+                constexpr std::size_t n = sizeof...(Rows);
+                constexpr State starts[n + 1] = { Rows::start_value()... };
+                constexpr State targets[n + 1] = { Rows::target_value()... };
+                constexpr bool actions[n + 1] = { Rows::has_action()... };
+                constexpr bool guards[n + 1] = { Rows::has_guard()... };
+                void (*const names[n + 1])(Writer&) = { &detail::write_event_name<Writer, typename Rows::event_type, events>... };
+
+                if (json) {
+                    out("{\"states\":[");
+                    bool first = true;
+                    for (std::size_t i = 0; i != 2 * n; ++i) {
+                        State state = i < n ? starts[i] : targets[i - n];
+                        bool seen = false;
+                        for (std::size_t j = 0; j != i; ++j) {
+                            seen = seen || state == (j < n ? starts[j] : targets[j - n]);
+                        }
+                        if (!seen) {
+                            out(first ? "" : ",");
+                            detail::write_number(out, static_cast<long long>(state));
+                            first = false;
+                        }
+                    }
+                    out("],\"rows\":[");
+                } else {
+                    out("digraph {\n");
+                }
+                for (std::size_t i = 0; i != n; ++i) {
+                    if (json) {
+                        out(i == 0 ? "{\"start\":" : ",{\"start\":");
+                        detail::write_number(out, static_cast<long long>(starts[i]));
+                        out(",\"event\":");
+                        names[i](out);
+                        out(",\"target\":");
+                        detail::write_number(out, static_cast<long long>(targets[i]));
+                        out(actions[i] ? ",\"action\":true" : ",\"action\":false");
+                        out(guards[i] ? ",\"guard\":true" : ",\"guard\":false");
+                        if (counts) {
+                            out(",\"transitions\":");
+                            detail::write_number(out, static_cast<long long>(counts[i]));
+                        }
+                        out("}");
+                    } else {
+                        out("  ");
+                        detail::write_number(out, static_cast<long long>(starts[i]));
+                        out(" -> ");
+                        detail::write_number(out, static_cast<long long>(targets[i]));
+                        out(" [label=");
+                        names[i](out);
+                        out(guards[i] ? " + \"[]\"" : "");
+                        out(actions[i] ? " + \"/\"" : "");
+                        if (counts) {
+                            out(", weight=");
+                            detail::write_number(out, static_cast<long long>(counts[i]));
+                        }
+                        out("];\n");
+                    }
+                }
+                out(json ? "]}" : "}\n");
+            }
+        };
+
+        template<class Writer>
+        static void write_graph(Writer& out, bool json, const unsigned long* counts) {
+            using writer = typename detail::apply<graph_writer, typename Derived::transition_table>::type;
+            writer::write(out, json, counts);
+        }
+
+        template<class Event>
+        static State reject(Derived& self, const Event& event) {
+            count_event<Event>(1);
+            return self.no_transition(event);
+        }
+
+        template<class...>
+        struct handle_completion {
+            static bool execute(Derived&, State&) {
+                return false;
+            }
+        };
+
+        template<class T, class... Types>
+        struct handle_completion<detail::list<T, Types...>> {
+            static bool execute(Derived& self, State& state) {
+                if (state == T::start_value() && guard_holds<T>(self, completion())) {
+                    state = transition<T>(self, completion());
+                    return true;
+                } else {
+                    return handle_completion<detail::list<Types...>>::execute(self, state);
+                }
+            }
+        };
+
+        template<class...> struct completion_graph;
+
+        template<class... Rows>
+        struct completion_graph<detail::list<Rows...>> {
+            static constexpr std::size_t size = sizeof...(Rows);
+
+            // whether a completion row can fire after another one
+            static constexpr bool is_acyclic() {
+                if constexpr (size != 0) {
+                    constexpr State starts[] = { Rows::start_value()... };
+                    constexpr State targets[] = { Rows::target_value()... };
+                    bool reach[size][size] = {};
+                    for (std::size_t i = 0; i != size; ++i) {
+                        for (std::size_t j = 0; j != size; ++j) {
+                            reach[i][j] = targets[i] == starts[j];
+                        }
+                    }
+                    for (std::size_t k = 0; k != size; ++k) {
+                        for (std::size_t i = 0; i != size; ++i) {
+                            for (std::size_t j = 0; j != size; ++j) {
+                                reach[i][j] = reach[i][j] || (reach[i][k] && reach[k][j]);
+                            }
+                        }
+                    }
+                    for (std::size_t i = 0; i != size; ++i) {
+                        if (reach[i][i]) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+        };
+
+        // execute completion transitions until none is enabled; in
+        // an acyclic graph, every row fires at most once
+        void complete(Derived& self) {
+            using rows = typename by_event_type<completion, typename Derived::transition_table>::type;
+            using graph = completion_graph<rows>;
+            static_assert(graph::is_acyclic(), "completion transitions must not form cycles");
+            if constexpr (graph::size != 0) {
+                for (std::size_t n = 0; n != graph::size; ++n) {
+                    if (!handle_completion<rows>::execute(self, m_state)) {
+                        break;
+                    }
+                }
+            }
+        }
+
+    private:
+        void record_state() {
+            if constexpr (HistorySize != 0) {
+                this->push_history(m_state);
+            }
+        }
+
+    private:
+        state_type m_state;
+
+    private:
+#if !defined(NDEBUG) && (!__GNUC__ || __EXCEPTIONS)
+        class processing_lock {
+        public:
+            processing_lock(fsm& m) : processing(m.processing) {
+                if (processing) {
+                    throw std::logic_error("process_event called recursively");
+                }
+                processing = true;
+            }
+            ~processing_lock() {
+                processing = false;
+            }
+        private:
+            bool& processing;
+        };
+        bool processing = false;
+#else
+        struct processing_lock {
+            processing_lock(fsm&) {}
+        };
+#endif
+    };
+
+    /**
+     * Type-erased state machine class template.
+     *
+     * An `any_fsm` holds a state machine of any type with a common
+     * state type in internal storage, without heap allocation.  All
+     * events in a closed set of event types are dispatched through a
+     * flat table of function pointers generated for each state
+     * machine type, i.e. with a single indirect call per event.
+     *
+     * @tparam State the state machines' state type
+     *
+     * @tparam Events an `event_list` of the event types to process
+     *
+     * @tparam Size the size of the internal storage in bytes
+     */
+    template<class State, class Events, std::size_t Size = 8 * sizeof(void*)>
+    class any_fsm;
+
+    template<class State, class... Events, std::size_t Size>
+    class any_fsm<State, event_list<Events...>, Size> {
+        static_assert(sizeof...(Events) != 0, "any_fsm requires at least one event type");
+
+    public:
+        /**
+         * The state machines' state type.
+         */
+        typedef State state_type;
+
+        /**
+         * The event types that can be processed.
+         */
+        typedef event_list<Events...> event_types;
+
+    public:
+        /**
+         * Create an empty `any_fsm`.
+         */
+        any_fsm() noexcept : m_vtable(nullptr) {}
+
+        /**
+         * Create an `any_fsm` holding a state machine.
+         *
+         * @param machine the state machine to store
+         */
+        template<
+            class Machine,
+            class T = typename std::decay<Machine>::type,
+            class = typename std::enable_if<!std::is_same<T, any_fsm>::value>::type
+        >
+        any_fsm(Machine&& machine) : m_vtable(&vtable_for<T>) {
+            static_assert(sizeof(T) <= Size, "state machine exceeds any_fsm storage size");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "state machine is overaligned");
+            static_assert(std::is_nothrow_move_constructible<T>::value, "state machine must be nothrow move constructible");
+            ::new (static_cast<void*>(m_storage)) T(detail::forward<Machine>(machine));
+        }
+
+        any_fsm(const any_fsm&) = delete;
+
+        any_fsm(any_fsm&& other) noexcept : m_vtable(other.m_vtable) {
+            if (m_vtable) {
+                m_vtable->move(m_storage, other.m_storage);
+                other.m_vtable = nullptr;
+            }
+        }
+
+        ~any_fsm() {
+            reset();
+        }
+
+        any_fsm& operator=(const any_fsm&) = delete;
+
+        any_fsm& operator=(any_fsm&& other) noexcept {
+            if (this != &other) {
+                reset();
+                if (other.m_vtable) {
+                    other.m_vtable->move(m_storage, other.m_storage);
+                    m_vtable = other.m_vtable;
+                    other.m_vtable = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        /**
+         * Destroy the contained state machine, if any.
+         */
+        void reset() noexcept {
+            if (m_vtable) {
+                m_vtable->destroy(m_storage);
+                m_vtable = nullptr;
+            }
+        }
+
+        /**
+         * Return whether a state machine is contained.
+         */
+        explicit operator bool() const noexcept { return m_vtable != nullptr; }
+
+        /**
+         * Process an event.
+         *
+         * @warning The behavior is undefined if no state machine is
+         * contained.
+         *
+         * @tparam Event the event type, which must be one of `Events`
+         *
+         * @param event the event instance
+         */
+        template<class Event>
+        void process_event(const Event& event) {
+            constexpr std::size_t index = event_types::template index_of<Event>();
+            static_assert(index != event_types::size(), "event type not in any_fsm event list");
+            m_vtable->process[index](m_storage, &event);
+        }
+
+        /**
+         * Return the contained state machine's current state.
+         *
+         * @warning The behavior is undefined if no state machine is
+         * contained.
+         */
+        state_type current_state() const {
+            return m_vtable->current_state(m_storage);
+        }
+
+        /**
+         * Return a pointer to the contained state machine.
+         *
+         * @tparam Machine the state machine type
+         *
+         * @return a pointer to the contained state machine, or
+         * `nullptr` if it is not of type `Machine`
+         */
+        template<class Machine>
+        Machine* target() noexcept {
+            return m_vtable == &vtable_for<Machine> ? reinterpret_cast<Machine*>(m_storage) : nullptr;
+        }
+
+        /**
+         * Return a pointer to the contained state machine.
+         *
+         * @tparam Machine the state machine type
+         *
+         * @return a pointer to the contained state machine, or
+         * `nullptr` if it is not of type `Machine`
+         */
+        template<class Machine>
+        const Machine* target() const noexcept {
+            return m_vtable == &vtable_for<Machine> ? reinterpret_cast<const Machine*>(m_storage) : nullptr;
+        }
+
+    private:
+        struct vtable_type {
+            void (*destroy)(void*) noexcept;
+            void (*move)(void*, void*) noexcept;
+            State (*current_state)(const void*);
+            void (*process[sizeof...(Events)])(void*, const void*);
+        };
+
+        template<class Machine>
+        static void destroy(void* p) noexcept {
+            static_cast<Machine*>(p)->~Machine();
+        }
+
+        template<class Machine>
+        static void move(void* to, void* from) noexcept {
+            Machine* m = static_cast<Machine*>(from);
+            ::new (to) Machine(static_cast<Machine&&>(*m));
+            m->~Machine();
+        }
+
+        template<class Machine>
+        static State current_state(const void* p) {
+            return static_cast<const Machine*>(p)->current_state();
+        }
+
+        template<class Machine, class Event>
+        static void process(void* p, const void* event) {
+            static_cast<Machine*>(p)->process_event(*static_cast<const Event*>(event));
+        }
+
+        template<class Machine>
+        static constexpr vtable_type vtable_for = {
+            &destroy<Machine>,
+            &move<Machine>,
+            &current_state<Machine>,
+            { &process<Machine, Events>... }
+        };
+
+    private:
+        const vtable_type* m_vtable;
+        alignas(std::max_align_t) unsigned char m_storage[Size];
+    };
+
+    /**
+     * Single-producer, single-consumer event queue class template.
+     *
+     * An `event_queue` passes events from a single producer, e.g. an
+     * interrupt handler, to a single consumer, e.g. a main loop
+     * running a state machine.  Events are copied into a fixed-size
+     * ring buffer, without heap allocation or locking, so posting an
+     * event is wait-free and may be done from an interrupt handler.
+     *
+     * Runs of duplicate events of coalescable event types, as given
+     * by `event_coalesce`, are merged by the consumer, which only
+     * processes the last event of each run.
+     *
+     * @tparam Events an `event_list` of the event types to pass
+     *
+     * @tparam Capacity the maximum number of queued events
+     */
+    template<class Events, std::size_t Capacity>
+    class event_queue;
+
+    template<class... Events, std::size_t Capacity>
+    class event_queue<event_list<Events...>, Capacity> {
+        static_assert(sizeof...(Events) != 0, "event_queue requires at least one event type");
+        static_assert(Capacity != 0, "event_queue requires a non-zero capacity");
+        static_assert((std::is_nothrow_copy_constructible<Events>::value && ...),
+                      "events must be nothrow copy constructible");
+        static_assert(std::atomic<std::size_t>::is_always_lock_free, "event_queue requires lock-free atomics");
+
+    public:
+        /**
+         * The event types that can be queued.
+         */
+        typedef event_list<Events...> event_types;
+
+    public:
+        /**
+         * Create an empty `event_queue`.
+         */
+        event_queue() noexcept : m_head(0), m_tail(0), m_coalesced() {}
+
+        event_queue(const event_queue&) = delete;
+
+        ~event_queue() {
+            std::size_t head = m_head.load(std::memory_order_relaxed);
+            std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            for (; head != tail; head = next(head)) {
+                m_slots[head].destroy();
+            }
+        }
+
+        event_queue& operator=(const event_queue&) = delete;
+
+        /**
+         * Return the maximum number of queued events.
+         */
+        static constexpr std::size_t capacity() { return Capacity; }
+
+        /**
+         * Post an event to the queue.
+         *
+         * This member function must only be called by the producer.
+         *
+         * @param event the event to post
+         *
+         * @return `false` if the queue is full
+         */
+        template<class Event>
+        bool push(const Event& event) noexcept {
+            constexpr std::size_t index = event_types::template index_of<Event>();
+            static_assert(index != event_types::size(), "event type not contained in event_queue");
+            std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            std::size_t next_tail = next(tail);
+            if (next_tail == m_head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            ::new (static_cast<void*>(m_slots[tail].data)) Event(event);
+            m_slots[tail].index = static_cast<index_type>(index);
+            m_tail.store(next_tail, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Process the next queued event, if any.
+         *
+         * This member function must only be called by the consumer.
+         *
+         * @tparam Target a state machine, or any other type providing
+         * a `process_event()` member function template
+         *
+         * @param target the target to process the event
+         *
+         * @return `false` if the queue was empty
+         */
+        template<class Target>
+        bool pop(Target& target) {
+            std::size_t head = m_head.load(std::memory_order_relaxed);
+            std::size_t tail = m_tail.load(std::memory_order_acquire);
+            if (head == tail) {
+                return false;
+            }
+            head = coalesce(head, tail);
+            release guard{*this, head};
+            event_types::process_event(target, m_slots[head].index, m_slots[head].data);
+            return true;
+        }
+
+        /**
+         * Process all queued events.
+         *
+         * Events posted while draining the queue are left for the
+         * next call, so the number of events processed is bounded by
+         * the queue's capacity.
+         *
+         * This member function must only be called by the consumer.
+         *
+         * @tparam Target a state machine, or any other type providing
+         * a `process_event()` member function template
+         *
+         * @param target the target to process the events
+         *
+         * @return the number of events processed, not counting
+         * coalesced events
+         */
+        template<class Target>
+        std::size_t drain(Target& target) {
+            std::size_t head = m_head.load(std::memory_order_relaxed);
+            std::size_t tail = m_tail.load(std::memory_order_acquire);
+            std::size_t count = 0;
+            for (; head != tail; head = next(head), ++count) {
+                head = coalesce(head, tail);
+                release guard{*this, head};
+                event_types::process_event(target, m_slots[head].index, m_slots[head].data);
+            }
+            return count;
+        }
+
+        /**
+         * Return whether the queue is empty.
+         *
+         * The result may be outdated if called concurrently with
+         * `push()` or `pop()`.
+         */
+        bool empty() const noexcept {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Return the number of coalesced events of a given type,
+         * which were skipped by the consumer.
+         *
+         * This member function must only be called by the consumer.
+         *
+         * @tparam Event the event type
+         */
+        template<class Event>
+        std::size_t coalesced() const noexcept {
+            constexpr std::size_t index = event_types::template index_of<Event>();
+            static_assert(index != event_types::size(), "event type not contained in event_queue");
+            return m_coalesced[index];
+        }
+
+        /**
+         * Return the total number of coalesced events, which were
+         * skipped by the consumer.
+         *
+         * This member function must only be called by the consumer.
+         */
+        std::size_t coalesced() const noexcept {
+            std::size_t count = 0;
+            for (std::size_t n : m_coalesced) {
+                count += n;
+            }
+            return count;
+        }
+
+    private:
+        static constexpr std::size_t slots = Capacity + 1;
+
+        using index_type = detail::uint_for<sizeof...(Events)>;
+
+        static constexpr std::size_t storage_size() {
+            constexpr std::size_t sizes[] = { sizeof(Events)... };
+            std::size_t size = 0;
+            for (std::size_t s : sizes) {
+                size = s > size ? s : size;
+            }
+            return size;
+        }
+
+        struct slot {
+            alignas(Events...) unsigned char data[storage_size()];
+            index_type index;
+
+            void destroy() noexcept {
+                destructors[index](data);
+            }
+        };
+
+        // frees a slot after processing, even if processing throws
+        struct release {
+            event_queue& queue;
+            std::size_t head;
+
+            ~release() {
+                queue.m_slots[head].destroy();
+                queue.m_head.store(next(head), std::memory_order_release);
+            }
+        };
+
+        template<class Event>
+        static void destructor(void* p) noexcept {
+            static_cast<Event*>(p)->~Event();
+        }
+
+        static constexpr void (*destructors[sizeof...(Events)])(void*) noexcept = { &destructor<Events>... };
+
+        template<class Event>
+        static bool duplicate(const void* lhs, const void* rhs) {
+            if constexpr (detail::is_equality_comparable<Event>::value) {
+                return *static_cast<const Event*>(lhs) == *static_cast<const Event*>(rhs);
+            } else {
+                return true;
+            }
+        }
+
+        using duplicate_type = bool (*)(const void*, const void*);
+
+        template<class Event>
+        static constexpr duplicate_type duplicate_for() {
+            return event_coalesce<Event>::value ? &duplicate<Event> : nullptr;
+        }
+
+        static constexpr duplicate_type duplicates[sizeof...(Events)] = { duplicate_for<Events>()... };
+
+        // skip queued events followed by a duplicate, and return the
+        // index of the next event to process
+        std::size_t coalesce(std::size_t head, std::size_t tail) {
+            if constexpr ((event_coalesce<Events>::value || ...)) {
+                for (std::size_t n = next(head); n != tail; head = n, n = next(n)) {
+                    const slot& s = m_slots[head];
+                    duplicate_type dup = duplicates[s.index];
+                    if (!dup || m_slots[n].index != s.index || !dup(s.data, m_slots[n].data)) {
+                        break;
+                    }
+                    ++m_coalesced[s.index];
+                    release guard{*this, head};
+                }
+            }
+            return head;
+        }
+
+        static constexpr std::size_t next(std::size_t index) {
+            return index + 1 != slots ? index + 1 : 0;
+        }
+
+    private:
+        std::atomic<std::size_t> m_head;
+        std::atomic<std::size_t> m_tail;
+        slot m_slots[slots];
+        std::size_t m_coalesced[sizeof...(Events)];
+    };
+
+    namespace detail {
+        // fixed-size slab of events of a single type, which are kept
+        // alive when recycled so their resources can be reused
+        template<class Event, std::size_t Capacity>
+        class pool_slab {
+        protected:
+            pool_slab() noexcept : m_used(0), m_constructed(0) {}
+
+            ~pool_slab() {
+                for (std::size_t i = 0; i != m_constructed; ++i) {
+                    slot(i)->~Event();
+                }
+            }
+
+            Event* acquire() {
+                if (m_used == Capacity) {
+                    return nullptr;
+                } else if (m_used == m_constructed) {
+                    ::new (static_cast<void*>(m_storage[m_constructed])) Event();
+                    ++m_constructed;
+                }
+                return slot(m_used++);
+            }
+
+            void recycle() noexcept {
+                m_used = 0;
+            }
+
+            std::size_t available() const noexcept {
+                return Capacity - m_used;
+            }
+
+        private:
+            Event* slot(std::size_t i) noexcept {
+                return std::launder(reinterpret_cast<Event*>(m_storage[i]));
+            }
+
+            std::size_t m_used;
+            std::size_t m_constructed;
+            alignas(Event) unsigned char m_storage[Capacity][sizeof(Event)];
         };
-#endif
+    }
+
+    /**
+     * Event pool class template.
+     *
+     * An `event_pool` provides a fixed number of slots for each event
+     * type in an `event_list`, without heap allocation.  Events are
+     * default constructed the first time their slot is acquired, and
+     * are not destroyed when the pool is recycled.  So events holding
+     * resources, e.g. strings assigned to by the caller, keep them
+     * across batches, and processing an event does not require
+     * allocating or freeing memory once the pool has warmed up.
+     *
+     * An `event_pool` is not thread-safe; a separate pool should be
+     * used for each thread.
+     *
+     * @tparam Events an `event_list` of the event types to store
+     *
+     * @tparam Capacity the number of slots for each event type
+     */
+    template<class Events, std::size_t Capacity>
+    class event_pool;
+
+    template<class... Events, std::size_t Capacity>
+    class event_pool<event_list<Events...>, Capacity> : private detail::pool_slab<Events, Capacity>... {
+        static_assert(Capacity != 0, "event_pool requires a non-zero capacity");
+        static_assert((std::is_default_constructible<Events>::value && ...),
+                      "events must be default constructible");
+
+        template<class Event>
+        using slab = detail::pool_slab<Event, Capacity>;
+
+    public:
+        /**
+         * The event types that can be stored.
+         */
+        typedef event_list<Events...> event_types;
+
+    public:
+        /**
+         * Create an empty `event_pool`.
+         */
+        event_pool() = default;
+
+        event_pool(const event_pool&) = delete;
+
+        event_pool& operator=(const event_pool&) = delete;
+
+        /**
+         * Return the number of slots for each event type.
+         */
+        static constexpr std::size_t capacity() { return Capacity; }
+
+        /**
+         * Acquire a slot for an event.
+         *
+         * The event is either default constructed, or holds the
+         * value of a previous event of the same type from before the
+         * pool was last recycled, and should be assigned to by the
+         * caller.
+         *
+         * @tparam Event the event type
+         *
+         * @return a handle to the event, or an empty handle if all
+         * slots for `Event` are in use
+         */
+        template<class Event>
+        event_handle<Event> acquire() {
+            static_assert(event_types::template index_of<Event>() != event_types::size(),
+                          "event type not contained in event_pool");
+            return event_handle<Event>(slab<Event>::acquire());
+        }
+
+        /**
+         * Return the number of available slots for an event type.
+         *
+         * @tparam Event the event type
+         */
+        template<class Event>
+        std::size_t available() const noexcept {
+            return slab<Event>::available();
+        }
+
+        /**
+         * Make all slots available again, invalidating all handles.
+         *
+         * Events are not destroyed, so they can be reused.
+         */
+        void recycle() noexcept {
+            (slab<Events>::recycle(), ...);
+        }
+    };
+
+    /**
+     * State machine population class template.
+     *
+     * A `population` stores a fixed number of state machines of the
+     * same type, without heap allocation, and keeps them in buckets
+     * by their current state.  Broadcasting an event only visits
+     * machines in start states of transition table rows for the
+     * event, which are determined at compile time, so machines that
+     * could only call `no_transition()` are skipped.  Buckets are
+     * updated on each transition, so stored machines must only
+     * process events through their population.
+     *
+     * @tparam Machine the state machine type, which must have an
+     * integral or enumeration state type
+     *
+     * @tparam Capacity the maximum number of state machines
+     */
+    template<class Machine, std::size_t Capacity>
+    class population {
+        static_assert(Capacity != 0, "population requires a non-zero capacity");
+        static_assert(std::is_integral<typename Machine::state_type>::value ||
+                      std::is_enum<typename Machine::state_type>::value,
+                      "population requires an integral or enumeration state type");
+
+    public:
+        /**
+         * The state machines' state type.
+         */
+        typedef typename Machine::state_type state_type;
+
+    public:
+        /**
+         * Create an empty `population`.
+         */
+        population() noexcept : m_size(0) {
+            for (index_type& head : m_head) {
+                head = none;
+            }
+        }
+
+        population(const population&) = delete;
+
+        ~population() {
+            for (std::size_t i = 0; i != m_size; ++i) {
+                get(i).~Machine();
+            }
+        }
+
+        population& operator=(const population&) = delete;
+
+        /**
+         * Return the maximum number of state machines.
+         */
+        static constexpr std::size_t capacity() { return Capacity; }
+
+        /**
+         * Return the number of state machines.
+         */
+        std::size_t size() const noexcept { return m_size; }
+
+        /**
+         * Construct a state machine in place.
+         *
+         * @param args the arguments to pass to the state machine's
+         * constructor
+         *
+         * @return the index of the new state machine, or `capacity()`
+         * if the population is full
+         */
+        template<class... Args>
+        std::size_t emplace(Args&&... args) {
+            if (m_size == Capacity) {
+                return Capacity;
+            }
+            ::new (static_cast<void*>(m_storage[m_size])) Machine(detail::forward<Args>(args)...);
+            link(m_size, bucket_of(get(m_size).current_state()));
+            return m_size++;
+        }
+
+        /**
+         * Return a state machine by index.
+         */
+        const Machine& operator[](std::size_t index) const noexcept {
+            return const_cast<population&>(*this).get(index);
+        }
+
+        /**
+         * Process an event with a single state machine.
+         *
+         * @param index the index of the state machine
+         *
+         * @param event the event instance
+         */
+        template<class Event>
+        void process_event(std::size_t index, const Event& event) {
+            Machine& m = get(index);
+            std::size_t bucket = bucket_of(m.current_state());
+            m.process_event(event);
+            std::size_t target = bucket_of(m.current_state());
+            if (target != bucket) {
+                unlink(index, bucket);
+                link(index, target);
+            }
+        }
+
+        /**
+         * Process an event with all state machines whose current
+         * state is the start state of a transition table row for the
+         * event type.
+         *
+         * Each state machine processes the event at most once, even
+         * if it transitions to another state accepting the event.
+         *
+         * If all rows for the event from a state have column guards,
+         * i.e. guards that are pointers to data members, the guards
+         * are first evaluated for batches of state machines in that
+         * state, and only machines for which any of them holds
+         * process the event.  Other machines in that state are
+         * skipped, without calling `no_transition()`.
+         *
+         * @param event the event instance
+         *
+         * @return the number of state machines that processed the
+         * event
+         */
+        template<class Event>
+        std::size_t broadcast(const Event& event) {
+            constexpr bucket_mask accepting = accepting_buckets<Event>();
+            index_type detached[buckets];
+            for (std::size_t b = 0; b != states::size; ++b) {
+                detached[b] = accepting.value[b] ? m_head[b] : none;
+                if (accepting.value[b]) {
+                    m_head[b] = none;
+                }
+            }
+            std::size_t count = 0;
+            for (std::size_t b = 0; b != states::size; ++b) {
+                if (auto evaluate = states::template column_masks<Event>[b]) {
+                    count += process_batches(detached[b], event, evaluate);
+                    continue;
+                }
+                for (index_type i = detached[b], next; i != none; i = next, ++count) {
+                    next = m_next[i];
+                    Machine& m = get(i);
+                    m.process_event(event);
+                    link(i, bucket_of(m.current_state()));
+                }
+            }
+            return count;
+        }
+
+    private:
+        // one bucket per start state, plus one for all other states
+        using states = typename Machine::template start_state_table<>;
+
+        static constexpr std::size_t buckets = states::size + 1;
+
+        using index_type = detail::uint_for<Capacity>;
+
+        static constexpr index_type none = static_cast<index_type>(Capacity);
+
+        struct bucket_mask {
+            bool value[buckets];
+        };
+
+        template<class Event>
+        static constexpr bucket_mask accepting_buckets() {
+            bucket_mask mask = {};
+            for (std::size_t b = 0; b != states::size; ++b) {
+                mask.value[b] = Machine::template accepts<Event>(states::values[b]);
+            }
+            return mask;
+        }
+
+        // evaluate column guards for a detached list in batches, so
+        // the compiler may vectorize the loops over the guard fields
+        template<class Event, class Evaluate>
+        std::size_t process_batches(index_type first, const Event& event, Evaluate evaluate) {
+            constexpr std::size_t lanes = 64;
+            const Machine* batch[lanes];
+            index_type indices[lanes];
+            bool mask[lanes];
+            std::size_t count = 0;
+            for (index_type i = first; i != none;) {
+                std::size_t n = 0;
+                for (; i != none && n != lanes; i = m_next[i], ++n) {
+                    indices[n] = i;
+                    batch[n] = &get(i);
+                }
+                evaluate(batch, n, mask);
+                for (std::size_t j = 0; j != n; ++j) {
+                    Machine& m = get(indices[j]);
+                    if (mask[j]) {
+                        m.process_event(event);
+                        ++count;
+                    }
+                    link(indices[j], bucket_of(m.current_state()));
+                }
+            }
+            return count;
+        }
+
+        static std::size_t bucket_of(state_type state) {
+            return states::keys::find(static_cast<unsigned long long>(state));
+        }
+
+        Machine& get(std::size_t index) noexcept {
+            return *std::launder(reinterpret_cast<Machine*>(m_storage[index]));
+        }
+
+        void link(std::size_t index, std::size_t bucket) noexcept {
+            m_prev[index] = none;
+            m_next[index] = m_head[bucket];
+            if (m_head[bucket] != none) {
+                m_prev[m_head[bucket]] = static_cast<index_type>(index);
+            }
+            m_head[bucket] = static_cast<index_type>(index);
+        }
+
+        void unlink(std::size_t index, std::size_t bucket) noexcept {
+            if (m_prev[index] != none) {
+                m_next[m_prev[index]] = m_next[index];
+            } else {
+                m_head[bucket] = m_next[index];
+            }
+            if (m_next[index] != none) {
+                m_prev[m_next[index]] = m_prev[index];
+            }
+        }
+
+    private:
+        std::size_t m_size;
+        index_type m_head[buckets];
+        index_type m_next[Capacity];
+        index_type m_prev[Capacity];
+        alignas(Machine) unsigned char m_storage[Capacity][sizeof(Machine)];
+    };
+
+    /**
+     * Event route class template.
+     *
+     * A route declares that events of a given type processed by one
+     * state machine are forwarded to another, optionally converted
+     * to another event type.
+     *
+     * @tparam From the state machine type forwarding events
+     *
+     * @tparam Event the event type to forward
+     *
+     * @tparam To the state machine type receiving events
+     *
+     * @tparam convert a function or member function of `From`
+     * converting the event, called with the `From` state machine
+     * and/or the event, or `nullptr` to forward the event itself
+     */
+    template<class From, class Event, class To, auto convert = nullptr>
+    struct route {
+        typedef From from_type;
+        typedef Event event_type;
+        typedef To to_type;
+
+        /**
+         * Return the event to pass to the receiving state machine.
+         */
+        static decltype(auto) output(const From& from, const Event& event) {
+            if constexpr (std::is_null_pointer<decltype(convert)>::value) {
+                return (event);
+            } else {
+                return detail::invoke_as_binary_fn(convert, from, event);
+            }
+        }
+
+        /**
+         * The type of event passed to the receiving state machine.
+         */
+        typedef typename std::decay<decltype(
+            output(*static_cast<const From*>(nullptr), *static_cast<const Event*>(nullptr))
+        )>::type output_type;
+    };
+
+    /**
+     * Event routing table class template.
+     *
+     * @tparam Routes the `route` instances
+     */
+    template<class... Routes>
+    struct wiring {};
+
+    namespace detail {
+        template<class T, class List> struct contains;
+
+        template<class T, class... Types>
+        struct contains<T, list<Types...>> : std::integral_constant<bool, (std::is_same<T, Types>::value || ...)> {};
+
+        // a route's forwarded event when queued on a back edge
+        template<class Route>
+        struct back_edge {
+            typename Route::output_type event;
+        };
+
+        template<class Machine>
+        struct network_node {
+            Machine machine;
+        };
+
+        struct no_back_edges {};
+    }
+
+    /**
+     * State machine network class template.
+     *
+     * A network owns one state machine of each type named in a
+     * `wiring` of routes.  After a state machine has processed an
+     * event, the event is forwarded along all matching routes in
+     * their given order, each receiving state machine completing its
+     * transition, and forwarding the event further, before the next
+     * route is followed.  Forwarding uses direct calls resolved at
+     * compile time.
+     *
+     * Routes that would deliver an event to a state machine which is
+     * still forwarding, i.e. back edges of the routing graph, instead
+     * push the event to a bounded queue, which is drained after all
+     * direct calls have completed.  For acyclic routing graphs, no
+     * queue is created.
+     *
+     * @tparam Wiring a `wiring` of routes
+     *
+     * @tparam QueueSize the maximum number of events queued on back
+     * edges
+     */
+    template<class Wiring, std::size_t QueueSize = 16>
+    class network;
+
+    template<class... Routes, std::size_t QueueSize>
+    class network<wiring<Routes...>, QueueSize> {
+        using machines = typename detail::unique<
+            detail::list<>, typename Routes::from_type..., typename Routes::to_type...
+        >::type;
+
+        template<class> struct nodes;
+
+        template<class... Machines>
+        struct nodes<detail::list<Machines...>> : detail::network_node<Machines>... {
+            static constexpr std::size_t size = sizeof...(Machines);
+        };
+
+        static constexpr std::size_t machine_count = nodes<machines>::size;
+
+        template<class Machine>
+        static constexpr std::size_t machine_index = detail::index_of<Machine, machines>::value;
+
+        // whether some machine can reach itself along routes
+        static constexpr bool is_cyclic() {
+            bool reach[machine_count][machine_count] = {};
+            constexpr std::size_t from[] = { machine_index<typename Routes::from_type>... };
+            constexpr std::size_t to[] = { machine_index<typename Routes::to_type>... };
+            for (std::size_t i = 0; i != sizeof...(Routes); ++i) {
+                reach[from[i]][to[i]] = true;
+            }
+            for (std::size_t k = 0; k != machine_count; ++k) {
+                for (std::size_t i = 0; i != machine_count; ++i) {
+                    for (std::size_t j = 0; j != machine_count; ++j) {
+                        reach[i][j] = reach[i][j] || (reach[i][k] && reach[k][j]);
+                    }
+                }
+            }
+            for (std::size_t i = 0; i != machine_count; ++i) {
+                if (reach[i][i]) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        using queue_type = typename std::conditional<
+            is_cyclic(),
+            event_queue<event_list<detail::back_edge<Routes>...>, QueueSize>,
+            detail::no_back_edges
+        >::type;
+
+    public:
+        /**
+         * Create a network of default constructed state machines.
+         */
+        network() : m_dropped(0) {}
+
+        network(const network&) = delete;
+
+        network& operator=(const network&) = delete;
+
+        /**
+         * Return whether the routing graph has cycles, so back edges
+         * are queued.
+         */
+        static constexpr bool has_back_edges() { return is_cyclic(); }
+
+        /**
+         * Return a state machine of the network.
+         *
+         * @tparam Machine the state machine type
+         */
+        template<class Machine>
+        Machine& get() noexcept {
+            static_assert(detail::contains<Machine, machines>::value, "state machine type not in network");
+            return static_cast<detail::network_node<Machine>&>(m_nodes).machine;
+        }
+
+        /**
+         * Process an event with a state machine, and forward it along
+         * all routes until no more events are pending.
+         *
+         * @tparam Machine the state machine type to process the event
+         *
+         * @param event the event instance
+         */
+        template<class Machine, class Event>
+        void process_event(const Event& event) {
+            deliver<Machine, detail::list<>>(event);
+            if constexpr (is_cyclic()) {
+                back_edge_target target = { *this };
+                while (m_queue.drain(target)) {
+                }
+            }
+        }
+
+        /**
+         * Return the number of events dropped because the back edge
+         * queue was full.
+         */
+        std::size_t dropped() const noexcept { return m_dropped; }
+
+    private:
+        struct back_edge_target {
+            network& self;
+
+            template<class Route>
+            void process_event(const detail::back_edge<Route>& queued) {
+                self.template deliver<typename Route::to_type, detail::list<>>(queued.event);
+            }
+        };
+
+        template<class Machine, class Path, class Event>
+        void deliver(const Event& event) {
+            get<Machine>().process_event(event);
+            using path = typename detail::concat<Machine, Path>::type;
+            (forward<Routes, Machine, path>(event), ...);
+        }
+
+        template<class Route, class Machine, class Path, class Event>
+        void forward(const Event& event) {
+            if constexpr (std::is_same<typename Route::from_type, Machine>::value &&
+                          std::is_same<typename Route::event_type, Event>::value) {
+                using target = typename Route::to_type;
+                if constexpr (detail::contains<target, Path>::value) {
+                    detail::back_edge<Route> queued = { Route::output(get<Machine>(), event) };
+                    if (!m_queue.push(queued)) {
+                        ++m_dropped;
+                    }
+                } else {
+                    deliver<target, Path>(Route::output(get<Machine>(), event));
+                }
+            }
+        }
+
+    private:
+        nodes<machines> m_nodes;
+        queue_type m_queue;
+        std::size_t m_dropped;
     };
 }
 
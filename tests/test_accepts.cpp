@@ -0,0 +1,112 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class player: public fsmlite::fsm<player> {
+    friend class fsmlite::fsm<player>;  // base class needs access to transition_table
+public:
+    enum states { Stopped, Open, Empty, Playing, Paused = 0x7f00 };
+
+    player(state_type init_state = Empty) : fsm(init_state) { }
+
+    struct play {};
+    struct open_close {};
+    struct cd_detected {};
+    struct stop {};
+    struct pause {};
+    struct unused {};
+
+    static bool never() { return false; }
+
+private:
+    using m = player;
+
+    using transition_table = table<
+//       Start    Event        Target   Action   Guard
+//  ----+--------+------------+--------+--------+----------+-
+    row< Stopped, play,        Playing                      >,
+    row< Stopped, open_close,  Open                         >,
+    row< Open,    open_close,  Empty                        >,
+    row< Empty,   open_close,  Open                         >,
+    row< Empty,   cd_detected, Stopped                      >,
+    row< Empty,   play,        Playing, nullptr, false      >,
+    row< Playing, stop,        Stopped                      >,
+    row< Playing, pause,       Paused                       >,
+    row< Playing, open_close,  Open                         >,
+    row< Paused,  play,        Playing, nullptr, &m::never  >,
+    row< Paused,  stop,        Stopped                      >,
+    row< Paused,  open_close,  Open                         >
+//  ----+--------+------------+--------+--------+----------+-
+    >;
+};
+
+// pointer states are not integral, so accepted event sets are computed
+const char closed[] = "closed";
+const char opened[] = "opened";
+
+class scoped: public fsmlite::fsm<scoped, const char*> {
+    friend class fsmlite::fsm<scoped, const char*>;  // base class needs access to transition_table
+public:
+    struct event {};
+
+    scoped() : fsm(closed) {}
+
+private:
+    using transition_table = table<
+        row< closed, event, opened >
+    >;
+};
+
+void test_accepts()
+{
+    static_assert(player::accepts<player::play>(player::Stopped), "play");
+    static_assert(!player::accepts<player::play>(player::Open), "play");
+    static_assert(!player::accepts<player::play>(player::Empty), "constant guard");
+    static_assert(player::accepts<player::play>(player::Paused), "guard");
+    static_assert(!player::accepts<player::unused>(player::Stopped), "unused");
+
+    assert(player::accepts<player::open_close>(player::Empty));
+    assert(!player::accepts<player::open_close>(42));
+}
+
+void test_accepted_events()
+{
+    auto stopped = player::accepted_events(player::Stopped);
+    assert(stopped.count() == 2);
+    assert(stopped.contains<player::play>());
+    assert(stopped.contains<player::open_close>());
+    assert(!stopped.contains<player::stop>());
+    assert(!stopped.contains<player::unused>());
+
+    auto empty = player::accepted_events(player::Empty);
+    assert(empty.count() == 2);
+    assert(empty.contains<player::open_close>());
+    assert(empty.contains<player::cd_detected>());
+    assert(!empty.contains<player::play>());
+
+    auto paused = player::accepted_events(player::Paused);
+    assert(paused.count() == 3);
+    assert((paused & stopped).count() == 2);
+    assert((paused | empty).count() == 4);
+    assert(paused != stopped);
+    assert((paused & empty) == (stopped & empty));
+
+    assert(player::accepted_events(42).empty());
+    assert(player::accepted_events(-1).empty());
+}
+
+void test_scoped()
+{
+    assert(scoped::accepts<scoped::event>(closed));
+    assert(!scoped::accepts<scoped::event>(opened));
+    assert(scoped::accepted_events(closed).contains<scoped::event>());
+    assert(scoped::accepted_events(opened).empty());
+}
+
+int main()
+{
+    test_accepts();
+    test_accepted_events();
+    test_scoped();
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "fsmlite.h"
+
+struct open_close {};
+struct play {};
+
+enum states { Open, Closed, Playing };
+
+class drawer: public fsmlite::fsm<drawer, states> {
+    friend class fsmlite::fsm<drawer, states>;  // base class needs access to transition_table
+public:
+    drawer() : fsm(Closed) {}
+
+private:
+    using transition_table = table<
+//       Start   Event       Target
+//  ----+-------+-----------+------+-
+    row< Open,   open_close, Closed >,
+    row< Closed, open_close, Open   >
+//  ----+-------+-----------+------+-
+    >;
+};
+
+class player: public fsmlite::fsm<player, states> {
+    friend class fsmlite::fsm<player, states>;  // base class needs access to transition_table
+public:
+    player(const std::string& title) : fsm(Closed), title(title) {}
+
+    std::string title;
+    int plays = 0;
+
+private:
+    void start_playback() { ++plays; }
+
+private:
+    using m = player;
+
+    using transition_table = table<
+//       Start    Event       Target   Action
+//  ----+--------+-----------+--------+-------------------+-
+    row< Closed,  play,       Playing, &m::start_playback  >,
+    row< Playing, open_close, Open                         >,
+    row< Open,    open_close, Closed                       >
+//  ----+--------+-----------+--------+-------------------+-
+    >;
+};
+
+using machine = fsmlite::any_fsm<states, fsmlite::event_list<open_close, play>>;
+
+void test_empty()
+{
+    machine m;
+    assert(!m);
+    assert(m.target<drawer>() == nullptr);
+    machine n(static_cast<machine&&>(m));
+    assert(!n);
+}
+
+void test_process()
+{
+    std::vector<machine> machines;
+    machines.emplace_back(drawer());
+    machines.emplace_back(player("louie, louie"));
+    machines.emplace_back(drawer());
+
+    for (machine& m : machines) {
+        assert(m);
+        assert(m.current_state() == Closed);
+        m.process_event(play());
+    }
+    assert(machines[0].current_state() == Closed);
+    assert(machines[1].current_state() == Playing);
+    assert(machines[2].current_state() == Closed);
+
+    for (machine& m : machines) {
+        m.process_event(open_close());
+    }
+    assert(machines[0].current_state() == Open);
+    assert(machines[1].current_state() == Open);
+    assert(machines[2].current_state() == Open);
+
+    assert(machines[0].target<player>() == nullptr);
+    assert(machines[1].target<player>() != nullptr);
+    assert(machines[1].target<player>()->title == "louie, louie");
+    assert(machines[1].target<player>()->plays == 1);
+}
+
+void test_move()
+{
+    machine m(player("help!"));
+    m.process_event(play());
+    machine n;
+    n = static_cast<machine&&>(m);
+    assert(!m);
+    assert(n);
+    assert(n.current_state() == Playing);
+    assert(n.target<player>()->title == "help!");
+    n.reset();
+    assert(!n);
+}
+
+int main()
+{
+    test_empty();
+    test_process();
+    test_move();
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <cassert>
+#include <cstring>
+
+#include "fsmlite.h"
+
+class comment_filter: public fsmlite::fsm<comment_filter> {
+    friend class fsmlite::fsm<comment_filter>;  // base class needs access to transition_table
+public:
+    enum states { Text, Comment };
+
+    struct reset {};
+
+private:
+    using transition_table = table<
+//       Start    Event                       Target
+//  ----+--------+---------------------------+--------+-
+    row< Text,    fsmlite::chars<'#'>,        Comment  >,
+    row< Text,    fsmlite::any_char,          Text     >,
+    row< Comment, fsmlite::chars<'\n'>,       Text     >,
+    row< Comment, fsmlite::not_chars<'\n'>,   Comment  >,
+    row< Comment, reset,                      Text     >
+//  ----+--------+---------------------------+--------+-
+    >;
+};
+
+class number: public fsmlite::fsm<number> {
+    friend class fsmlite::fsm<number>;  // base class needs access to transition_table
+public:
+    enum states { Init, Integer, Fraction, Error = 42 };
+
+    int errors = 0;
+
+private:
+    template<class Event>
+    state_type no_transition(const Event&) {
+        ++errors;
+        return Error;
+    }
+
+private:
+    using digit = fsmlite::char_range<'0', '9'>;
+
+    using transition_table = table<
+//       Start     Event                Target
+//  ----+---------+--------------------+---------+-
+    row< Init,     digit,               Integer   >,
+    row< Integer,  digit,               Integer   >,
+    row< Integer,  fsmlite::chars<'.'>, Fraction  >,
+    row< Fraction, digit,               Fraction  >
+//  ----+---------+--------------------+---------+-
+    >;
+};
+
+void process(comment_filter& m, const char* s)
+{
+    m.process_bytes(s, std::strlen(s));
+}
+
+void process(number& m, const char* s)
+{
+    m.process_bytes(s, std::strlen(s));
+}
+
+void test_comment()
+{
+    comment_filter m;
+    assert(m.current_state() == comment_filter::Text);
+    process(m, "");
+    assert(m.current_state() == comment_filter::Text);
+    process(m, "foo bar");
+    assert(m.current_state() == comment_filter::Text);
+    process(m, "foo # bar");
+    assert(m.current_state() == comment_filter::Comment);
+    process(m, " baz # qux");
+    assert(m.current_state() == comment_filter::Comment);
+    process(m, "\nfoo");
+    assert(m.current_state() == comment_filter::Text);
+    process(m, "#\n#");
+    assert(m.current_state() == comment_filter::Comment);
+    m.process_event(comment_filter::reset());
+    assert(m.current_state() == comment_filter::Text);
+    process(m, "\xff\x80#\xff\x80");
+    assert(m.current_state() == comment_filter::Comment);
+}
+
+void test_number()
+{
+    number m;
+    process(m, "0123");
+    assert(m.current_state() == number::Integer);
+    process(m, ".45");
+    assert(m.current_state() == number::Fraction);
+    assert(m.errors == 0);
+    process(m, ".");
+    assert(m.current_state() == number::Error);
+    assert(m.errors == 1);
+    process(m, "12");
+    assert(m.current_state() == number::Error);
+    assert(m.errors == 3);
+}
+
+int main()
+{
+    test_comment();
+    test_number();
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "fsmlite.h"
+
+class quotes: public fsmlite::fsm<quotes> {
+    friend class fsmlite::fsm<quotes>;  // base class needs access to transition_table
+public:
+    enum states { Text, Quoted, Escaped };
+
+private:
+    using transition_table = table<
+//       Start    Event                            Target
+//  ----+--------+--------------------------------+-------+-
+    row< Text,    fsmlite::chars<'"'>,             Quoted  >,
+    row< Text,    fsmlite::not_chars<'"'>,         Text    >,
+    row< Quoted,  fsmlite::chars<'"'>,             Text    >,
+    row< Quoted,  fsmlite::chars<'\\'>,            Escaped >,
+    row< Quoted,  fsmlite::not_chars<'"', '\\'>,   Quoted  >,
+    row< Escaped, fsmlite::any_char,               Quoted  >
+//  ----+--------+--------------------------------+-------+-
+    >;
+};
+
+class digits: public fsmlite::fsm<digits> {
+    friend class fsmlite::fsm<digits>;  // base class needs access to transition_table
+public:
+    enum states { Init, Digits, Error };
+
+private:
+    template<class Event>
+    state_type no_transition(const Event&) {
+        return Error;
+    }
+
+private:
+    using transition_table = table<
+//       Start   Event                           Target
+//  ----+-------+-------------------------------+------+-
+    row< Init,   fsmlite::char_range<'0', '9'>,  Digits >,
+    row< Digits, fsmlite::char_range<'0', '9'>,  Digits >
+//  ----+-------+-------------------------------+------+-
+    >;
+};
+
+void test_identity()
+{
+    quotes::byte_mapping id;
+    quotes::state_type s = quotes::Escaped;
+    assert(id.apply(s));
+    assert(s == quotes::Escaped);
+
+    quotes m;
+    assert(m.process_bytes(quotes::map_bytes("", 0)));
+    assert(m.current_state() == quotes::Text);
+}
+
+void test_chunks()
+{
+    std::string input;
+    for (int i = 0; i != 100; ++i) {
+        input += "foo \"bar\\\" baz\" qux \"\\\"\n";
+    }
+
+    quotes ref;
+    ref.process_bytes(input.data(), input.size());
+    assert(ref.current_state() == quotes::Quoted);
+
+    for (std::size_t chunk = 1; chunk <= input.size(); chunk = chunk * 2 + 1) {
+        quotes::byte_mapping mapping;
+        for (std::size_t pos = 0; pos < input.size(); pos += chunk) {
+            std::size_t n = input.size() - pos < chunk ? input.size() - pos : chunk;
+            mapping = mapping.then(quotes::map_bytes(input.data() + pos, n));
+        }
+        quotes m;
+        assert(m.process_bytes(mapping));
+        assert(m.current_state() == ref.current_state());
+    }
+}
+
+void test_no_transition()
+{
+    digits::byte_mapping head = digits::map_bytes("123", 3);
+    digits::byte_mapping tail = digits::map_bytes("4x5", 3);
+
+    digits m;
+    assert(m.process_bytes(head));
+    assert(m.current_state() == digits::Digits);
+    assert(!m.process_bytes(tail));
+    assert(m.current_state() == digits::Digits);
+    m.process_bytes("4x5", 3);
+    assert(m.current_state() == digits::Error);
+
+    digits::state_type s = digits::Init;
+    assert(!head.then(tail).apply(s));
+    assert(s == digits::Init);
+}
+
+int main()
+{
+    test_identity();
+    test_chunks();
+    test_no_transition();
+    return 0;
+}
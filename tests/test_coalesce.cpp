@@ -0,0 +1,133 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class session: public fsmlite::fsm<session> {
+    friend class fsmlite::fsm<session>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Reading };
+
+    // notifications for the same channel are idempotent
+    struct data_available {
+        static constexpr bool coalesce = true;
+        int channel;
+        bool operator==(const data_available& other) const { return channel == other.channel; }
+    };
+
+    struct wakeup {
+        static constexpr bool coalesce = true;
+    };
+
+    struct chunk { int size; };
+    struct close {};
+
+    int reads = 0;
+    int wakeups = 0;
+    int bytes = 0;
+
+private:
+    void read(const data_available&) { ++reads; }
+    void wake(const wakeup&) { ++wakeups; }
+    void add(const chunk& e) { bytes += e.size; }
+
+    using m = session;
+
+    using transition_table = table<
+//       Start    Event           Target   Action
+//  ----+--------+---------------+--------+---------+-
+    row< Idle,    data_available, Reading, &m::read  >,
+    row< Reading, data_available, Reading, &m::read  >,
+    row< Idle,    wakeup,         Idle,    &m::wake  >,
+    row< Reading, wakeup,         Reading, &m::wake  >,
+    row< Reading, chunk,          Reading, &m::add   >,
+    row< Reading, close,          Idle               >
+//  ----+--------+---------------+--------+---------+-
+    >;
+};
+
+using events = fsmlite::event_list<session::data_available, session::wakeup, session::chunk, session::close>;
+
+static_assert(fsmlite::event_coalesce<session::data_available>::value, "data_available is coalescable");
+static_assert(!fsmlite::event_coalesce<session::chunk>::value, "chunk is not coalescable");
+
+void test_drain()
+{
+    fsmlite::event_queue<events, 16> q;
+    session m;
+    for (int i = 0; i != 5; ++i) {
+        q.push(session::data_available{1});
+    }
+    q.push(session::data_available{2});
+    q.push(session::data_available{2});
+    q.push(session::chunk{10});
+    q.push(session::chunk{10});
+    q.push(session::wakeup());
+    q.push(session::wakeup());
+    q.push(session::wakeup());
+    std::size_t n = q.drain(m);
+    assert(n == 5);
+    assert(q.empty());
+    assert(m.reads == 2);
+    assert(m.bytes == 20);
+    assert(m.wakeups == 1);
+    assert(q.coalesced<session::data_available>() == 5);
+    assert(q.coalesced<session::chunk>() == 0);
+    assert(q.coalesced<session::wakeup>() == 2);
+    assert(q.coalesced() == 7);
+}
+
+void test_not_consecutive()
+{
+    fsmlite::event_queue<events, 8> q;
+    session m;
+    q.push(session::data_available{1});
+    q.push(session::chunk{1});
+    q.push(session::data_available{1});
+    q.push(session::close());
+    q.push(session::data_available{1});
+    std::size_t n = q.drain(m);
+    assert(n == 5);
+    assert(m.reads == 3);
+    assert(q.coalesced() == 0);
+}
+
+void test_pop()
+{
+    fsmlite::event_queue<events, 4> q;
+    session m;
+    q.push(session::wakeup());
+    q.push(session::wakeup());
+    q.push(session::data_available{1});
+    bool popped = q.pop(m);
+    assert(popped);
+    assert(m.wakeups == 1);
+    assert(q.coalesced() == 1);
+    popped = q.pop(m);
+    assert(popped);
+    assert(m.reads == 1);
+    assert(q.empty());
+}
+
+void test_wrap_around()
+{
+    fsmlite::event_queue<events, 3> q;
+    session m;
+    for (int i = 0; i != 10; ++i) {
+        q.push(session::data_available{i});
+        q.push(session::data_available{i});
+        q.push(session::data_available{i});
+        std::size_t n = q.drain(m);
+        assert(n == 1);
+    }
+    assert(m.reads == 10);
+    assert(q.coalesced() == 20);
+}
+
+int main()
+{
+    test_drain();
+    test_not_consecutive();
+    test_pop();
+    test_wrap_around();
+    return 0;
+}
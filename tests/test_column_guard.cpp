@@ -0,0 +1,81 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class account: public fsmlite::fsm<account> {
+    friend class fsmlite::fsm<account>;  // base class needs access to transition_table
+public:
+    enum states { Open, Closed };
+
+    account(unsigned credits = 0, bool vip = false) : fsm(Open), credits(credits), vip(vip) {}
+
+    struct charge {};
+    struct close {};
+
+    unsigned credits;
+    bool vip;
+    int rejected = 0;
+
+    template<class Event>
+    state_type no_transition(const Event&) {
+        ++rejected;
+        return current_state();
+    }
+
+private:
+    void debit(const charge&) { --credits; }
+
+    using m = account;
+
+    using transition_table = table<
+//       Start   Event   Target  Action     Guard
+//  ----+-------+-------+-------+----------+-----------+-
+    row< Open,   charge, Open,   &m::debit, &m::credits >,
+    row< Open,   charge, Open,   nullptr,   &m::vip     >,
+    row< Open,   close,  Closed                         >
+//  ----+-------+-------+-------+----------+-----------+-
+    >;
+};
+
+void test_single()
+{
+    account a(1);
+    a.process_event(account::charge());
+    assert(a.credits == 0);
+    assert(a.rejected == 0);
+    a.process_event(account::charge());
+    assert(a.credits == 0);
+    assert(a.rejected == 1);
+}
+
+void test_broadcast()
+{
+    // more instances than a single batch
+    fsmlite::population<account, 200> p;
+    for (unsigned i = 0; i != 200; ++i) {
+        p.emplace(i % 3, i % 10 == 0);
+    }
+    std::size_t n = p.broadcast(account::charge());
+    // instances with no credits and no vip flag are skipped
+    std::size_t expected = 0;
+    for (unsigned i = 0; i != 200; ++i) {
+        expected += (i % 3 != 0 || i % 10 == 0);
+    }
+    assert(n == expected);
+    for (unsigned i = 0; i != 200; ++i) {
+        assert(p[i].credits == (i % 3 != 0 ? i % 3 - 1 : 0));
+        assert(p[i].rejected == 0);
+    }
+    n = p.broadcast(account::close());
+    assert(n == 200);
+    n = p.broadcast(account::charge());
+    assert(n == 0);
+    (void)n;
+}
+
+int main()
+{
+    test_single();
+    test_broadcast();
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class order: public fsmlite::fsm<order> {
+    friend class fsmlite::fsm<order>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Validating, Accepted, Rejected, Shipping, Done };
+
+    struct submit { int amount; };
+    struct cancel {};
+    struct deliver {};
+
+    int amount = 0;
+    int notifications = 0;
+
+private:
+    void store(const submit& s) { amount = s.amount; }
+    void notify() { ++notifications; }
+
+    bool ok() const { return amount > 0; }
+    bool bad() const { return amount <= 0; }
+    bool large() const { return amount > 100; }
+
+private:
+    using m = order;
+    using completion = fsmlite::completion;
+
+    using transition_table = table<
+//       Start       Event       Target      Action      Guard
+//  ----+-----------+-----------+-----------+-----------+---------+-
+    row< Idle,       submit,     Validating, &m::store            >,
+    row< Validating, completion, Accepted,   nullptr,    &m::ok    >,
+    row< Validating, completion, Rejected,   nullptr,    &m::bad   >,
+    row< Accepted,   completion, Shipping,   &m::notify, &m::large >,
+    row< Accepted,   deliver,    Done                              >,
+    row< Shipping,   deliver,    Done                              >,
+    row< Rejected,   completion, Idle,       &m::notify            >,
+    row< Idle,       cancel,     Idle                              >
+//  ----+-----------+-----------+-----------+-----------+---------+-
+    >;
+};
+
+class plain: public fsmlite::fsm<plain> {
+    friend class fsmlite::fsm<plain>;  // base class needs access to transition_table
+public:
+    struct event {};
+
+private:
+    using transition_table = table<
+        row< 0, event, 1 >
+    >;
+};
+
+void test_accept()
+{
+    order o;
+    o.process_event(order::submit{42});
+    assert(o.current_state() == order::Accepted);
+    assert(o.notifications == 0);
+    o.process_event(order::deliver());
+    assert(o.current_state() == order::Done);
+}
+
+void test_chain()
+{
+    order o;
+    o.process_event(order::submit{1000});
+    assert(o.current_state() == order::Shipping);
+    assert(o.notifications == 1);
+}
+
+void test_reject()
+{
+    order o;
+    o.process_event(order::submit{0});
+    assert(o.current_state() == order::Idle);
+    assert(o.notifications == 1);
+    o.process_event(order::cancel());
+    assert(o.current_state() == order::Idle);
+    assert(o.notifications == 1);
+}
+
+void test_no_completion()
+{
+    plain p;
+    p.process_event(plain::event());
+    assert(p.current_state() == 1);
+}
+
+int main()
+{
+    test_accept();
+    test_chain();
+    test_reject();
+    test_no_completion();
+    return 0;
+}
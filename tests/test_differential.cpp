@@ -0,0 +1,250 @@
+// Differential test running pseudo-random transition tables through
+// all dispatch engines in lockstep.  Run with any argument to report
+// throughput per engine; build with -DFSMLITE_FUZZ and
+// -fsanitize=fuzzer to run under libFuzzer instead.
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fsmlite.h"
+
+constexpr int num_states = 6;
+constexpr int num_events = 4;
+constexpr std::size_t num_rows = 24;
+
+template<int N>
+struct ev {
+    int value;
+};
+
+using events = fsmlite::event_list<ev<0>, ev<1>, ev<2>, ev<3>>;
+
+struct row_spec {
+    int start;
+    int event;
+    int target;
+    bool guarded;
+};
+
+struct table_spec {
+    row_spec rows[num_rows];
+};
+
+constexpr unsigned next_random(unsigned long long& x) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<unsigned>(x >> 33);
+}
+
+template<unsigned Seed>
+constexpr table_spec make_spec() {
+    table_spec spec = {};
+    unsigned long long x = Seed;
+    for (row_spec& r : spec.rows) {
+        r.start = static_cast<int>(next_random(x) % num_states);
+        r.event = static_cast<int>(next_random(x) % num_events);
+        r.target = static_cast<int>(next_random(x) % num_states);
+        r.guarded = next_random(x) % 2 != 0;
+    }
+    return spec;
+}
+
+// guard outcomes only depend on their arguments, so they are the same
+// regardless of how often an engine evaluates them
+constexpr bool guard_outcome(std::size_t row, int value, int state) {
+    unsigned long long h = (row * 31 + static_cast<unsigned>(value)) * 131 + static_cast<unsigned>(state);
+    h ^= h >> 7;
+    h *= 0x9e3779b97f4a7c15ULL;
+    return (h >> 32) & 1;
+}
+
+template<unsigned Seed, bool Shared, bool Hashed = false>
+class machine: public fsmlite::fsm<machine<Seed, Shared, Hashed>> {
+    friend class fsmlite::fsm<machine>;  // base class needs access to transition_table
+    using base = fsmlite::fsm<machine>;
+
+public:
+    static constexpr bool shared_dispatch = Shared;
+    static constexpr bool hashed_dispatch = Hashed;
+    static constexpr table_spec spec = make_spec<Seed>();
+
+    using runtime_table = fsmlite::runtime_table<machine, events, num_states, num_rows>;
+
+    std::vector<int> trace;
+
+    template<std::size_t I>
+    void act(const ev<spec.rows[I].event>& e) {
+        trace.push_back(static_cast<int>(I));
+        trace.push_back(e.value);
+    }
+
+    template<std::size_t I>
+    bool guard(const ev<spec.rows[I].event>& e) const {
+        return guard_outcome(I, e.value, this->current_state());
+    }
+
+    template<class Event>
+    typename base::state_type no_transition(const Event& e) {
+        trace.push_back(-1);
+        trace.push_back(e.value);
+        return this->current_state();
+    }
+
+private:
+    template<std::size_t I, class Event = ev<spec.rows[I].event>>
+    using row_type = typename std::conditional<
+        spec.rows[I].guarded,
+        typename base::template row<spec.rows[I].start, Event, spec.rows[I].target, &machine::act<I>, &machine::guard<I>>,
+        typename base::template row<spec.rows[I].start, Event, spec.rows[I].target, &machine::act<I>>
+    >::type;
+
+    template<std::size_t... I>
+    static auto make_table(std::index_sequence<I...>) -> typename base::template table<row_type<I>...>;
+
+    using transition_table = decltype(make_table(std::make_index_sequence<num_rows>()));
+};
+
+template<class Machine, class Indices = std::make_index_sequence<num_rows>>
+struct registry;
+
+template<class Machine, std::size_t... I>
+struct registry<Machine, std::index_sequence<I...>> {
+    using table_type = typename Machine::runtime_table;
+
+    static constexpr typename table_type::action_type actions[] = {
+        table_type::template action_for<ev<Machine::spec.rows[I].event>, &Machine::template act<I>>...
+    };
+
+    static constexpr typename table_type::guard_type guards[] = {
+        table_type::template guard_for<ev<Machine::spec.rows[I].event>, &Machine::template guard<I>>...
+    };
+
+    static void load(table_type& table) {
+        const fsmlite::runtime_row rows[] = {
+            {
+                static_cast<unsigned short>(Machine::spec.rows[I].start),
+                static_cast<unsigned short>(Machine::spec.rows[I].event),
+                static_cast<unsigned short>(Machine::spec.rows[I].target),
+                static_cast<unsigned short>(I + 1),
+                static_cast<unsigned short>(Machine::spec.rows[I].guarded ? I + 1 : 0)
+            }...
+        };
+        bool loaded = table.load(rows, num_rows, actions, num_rows, guards, num_rows);
+        assert(loaded);
+        (void)loaded;
+    }
+};
+
+// each input byte encodes an event type and value
+template<class Machine, class... Table>
+void process(Machine& m, unsigned char op, const Table&... table) {
+    int value = op >> 2;
+    switch (op & 3) {
+    case 0:
+        m.process_event(table..., ev<0>{value});
+        break;
+    case 1:
+        m.process_event(table..., ev<1>{value});
+        break;
+    case 2:
+        m.process_event(table..., ev<2>{value});
+        break;
+    default:
+        m.process_event(table..., ev<3>{value});
+        break;
+    }
+}
+
+// return whether all engines produce identical states and traces
+template<unsigned Seed>
+bool differential(const unsigned char* ops, std::size_t n) {
+    typename machine<Seed, false>::runtime_table table;
+    registry<machine<Seed, false>>::load(table);
+
+    machine<Seed, false> chain;
+    machine<Seed, true> shared;
+    machine<Seed, false, true> hashed;
+    machine<Seed, false> runtime;
+    for (std::size_t i = 0; i != n; ++i) {
+        process(chain, ops[i]);
+        process(shared, ops[i]);
+        process(hashed, ops[i]);
+        process(runtime, ops[i], table);
+        if (chain.current_state() != shared.current_state() ||
+            chain.current_state() != hashed.current_state() ||
+            chain.current_state() != runtime.current_state()) {
+            return false;
+        }
+    }
+    return chain.trace == shared.trace && chain.trace == hashed.trace && chain.trace == runtime.trace;
+}
+
+template<class Machine, class... Table>
+void report(const char* name, const std::vector<unsigned char>& ops, const Table&... table) {
+    Machine m;
+    m.trace.reserve(4 * ops.size());
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned char op : ops) {
+        process(m, op, table...);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%-8s %12.0f events/s\n", name, static_cast<double>(ops.size()) / elapsed.count());
+}
+
+template<unsigned Seed>
+void throughput(const std::vector<unsigned char>& ops) {
+    typename machine<Seed, false>::runtime_table table;
+    registry<machine<Seed, false>>::load(table);
+
+    std::printf("seed %u\n", Seed);
+    report<machine<Seed, false>>("chain", ops);
+    report<machine<Seed, true>>("shared", ops);
+    report<machine<Seed, false, true>>("hashed", ops);
+    report<machine<Seed, false>>("runtime", ops, table);
+}
+
+#ifdef FSMLITE_FUZZ
+extern "C" int LLVMFuzzerTestOneInput(const unsigned char* data, std::size_t size) {
+    assert(differential<1>(data, size));
+    assert(differential<2>(data, size));
+    assert(differential<3>(data, size));
+    return 0;
+}
+#else
+std::vector<unsigned char> random_ops(unsigned seed, std::size_t n) {
+    std::mt19937 gen(seed);
+    std::vector<unsigned char> ops(n);
+    for (unsigned char& op : ops) {
+        op = static_cast<unsigned char>(gen());
+    }
+    return ops;
+}
+
+void test_differential()
+{
+    for (unsigned seed = 0; seed != 8; ++seed) {
+        std::vector<unsigned char> ops = random_ops(seed, 4096);
+        bool same1 = differential<1>(ops.data(), ops.size());
+        bool same2 = differential<2>(ops.data(), ops.size());
+        bool same3 = differential<3>(ops.data(), ops.size());
+        assert(same1 && same2 && same3);
+        (void)same1; (void)same2; (void)same3;
+    }
+}
+
+int main(int argc, char*[])
+{
+    test_differential();
+    if (argc > 1) {
+        std::vector<unsigned char> ops = random_ops(0, 1 << 22);
+        throughput<1>(ops);
+        throughput<2>(ops);
+        throughput<3>(ops);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,125 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class dense: public fsmlite::fsm<dense> {
+    friend class fsmlite::fsm<dense>;  // base class needs access to transition_table
+public:
+    enum states { Init, Running, Exit };
+
+    struct start { static constexpr int id = 1; };
+    struct stop { static constexpr int id = 2; };
+    struct tick { static constexpr int id = 3; int n; };
+    struct local {};  // not routable
+
+    int ticks = 0;
+
+private:
+    void on_tick(const tick& t) { ticks += t.n; }
+
+private:
+    using m = dense;
+
+    using transition_table = table<
+//       Start    Event  Target   Action
+//  ----+--------+------+--------+-----------+-
+    row< Init,    start, Running              >,
+    row< Running, tick,  Running, &m::on_tick >,
+    row< Running, stop,  Exit                 >,
+    row< Running, local, Exit                 >
+//  ----+--------+------+--------+-----------+-
+    >;
+};
+
+enum class opcode : unsigned short { hello = 0x1000, data = 0x7f00, bye = 0x0005 };
+
+class sparse: public fsmlite::fsm<sparse> {
+    friend class fsmlite::fsm<sparse>;  // base class needs access to transition_table
+public:
+    enum states { Closed, Open };
+
+    struct hello { static constexpr opcode id = opcode::hello; };
+    struct data { static constexpr opcode id = opcode::data; int size; };
+    struct bye { static constexpr opcode id = opcode::bye; };
+
+    int bytes = 0;
+
+private:
+    void on_data(const data& d) { bytes += d.size; }
+
+private:
+    using m = sparse;
+
+    using transition_table = table<
+//       Start   Event  Target  Action
+//  ----+-------+------+-------+-----------+-
+    row< Closed, hello, Open                >,
+    row< Open,   data,  Open,   &m::on_data >,
+    row< Open,   int,   Open                >,
+    row< Open,   bye,   Closed              >
+//  ----+-------+------+-------+-----------+-
+    >;
+};
+
+template<>
+struct fsmlite::event_id<int> : std::integral_constant<int, 1000000> {};
+
+void test_dense()
+{
+    dense m;
+    dense::start start;
+    dense::tick tick{5};
+    dense::stop stop;
+    assert(m.process_event_id(1, &start));
+    assert(m.current_state() == dense::Running);
+    assert(m.process_event_id(3, &tick));
+    assert(m.process_event_id(3, &tick));
+    assert(m.ticks == 10);
+    assert(!m.process_event_id(0, &stop));
+    assert(!m.process_event_id(4, &stop));
+    assert(!m.process_event_id(-1, &stop));
+    assert(m.current_state() == dense::Running);
+    assert(m.process_event_id(2, &stop));
+    assert(m.current_state() == dense::Exit);
+}
+
+void test_sparse()
+{
+    sparse m;
+    sparse::hello hello;
+    sparse::data data{42};
+    sparse::bye bye;
+    int i = 0;
+    assert(m.process_event_id(opcode::hello, &hello));
+    assert(m.current_state() == sparse::Open);
+    assert(m.process_event_id(0x7f00, &data));
+    assert(m.bytes == 42);
+    assert(m.process_event_id(1000000, &i));
+    for (unsigned id = 0; id != 0x10000; ++id) {
+        if (id != 0x1000 && id != 0x7f00 && id != 0x0005) {
+            assert(!m.process_event_id(id, &bye));
+        }
+    }
+    assert(m.current_state() == sparse::Open);
+    assert(m.process_event_id(opcode::bye, &bye));
+    assert(m.current_state() == sparse::Closed);
+}
+
+void test_event_list()
+{
+    using events = fsmlite::event_list<sparse::hello, sparse::bye>;
+    sparse m;
+    sparse::hello hello;
+    assert(events::process_event_id(m, 0x1000, &hello));
+    assert(m.current_state() == sparse::Open);
+    assert(!events::process_event_id(m, 0x7f00, &hello));
+    assert(!fsmlite::event_list<>::process_event_id(m, 0x1000, &hello));
+}
+
+int main()
+{
+    test_dense();
+    test_sparse();
+    test_event_list();
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "fsmlite.h"
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Running };
+
+    struct start { int value; };
+    struct stop {};
+    struct tick { int delta; };
+
+    using events = fsmlite::event_list<start, stop, tick>;
+
+    int value = 0;
+
+private:
+    void on_start(const start& e) { value = e.value; }
+    void on_tick(const tick& e) { value += e.delta; }
+
+private:
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start    Event  Target   Action
+//  ----+--------+------+--------+------------+-
+    row< Idle,    start, Running, &m::on_start >,
+    row< Running, tick,  Running, &m::on_tick  >,
+    row< Running, stop,  Idle                  >
+//  ----+--------+------+--------+------------+-
+    >;
+};
+
+// fixed-layout log record, as it would be read from a file
+struct record {
+    std::uint32_t type;
+    alignas(8) unsigned char data[8];
+};
+
+template<class Event>
+record make_record(const Event& event)
+{
+    static_assert(sizeof(Event) <= sizeof(record::data), "event too large");
+    record r = {};
+    r.type = state_machine::events::index_of<Event>();
+    std::memcpy(r.data, &event, sizeof event);
+    return r;
+}
+
+void test_index_of()
+{
+    using events = state_machine::events;
+    static_assert(events::size() == 3, "size");
+    static_assert(events::index_of<state_machine::start>() == 0, "start");
+    static_assert(events::index_of<state_machine::stop>() == 1, "stop");
+    static_assert(events::index_of<state_machine::tick>() == 2, "tick");
+    static_assert(events::index_of<int>() == 3, "int");
+    static_assert(fsmlite::event_list<>::size() == 0, "empty");
+    static_assert(fsmlite::event_list<>::index_of<int>() == 0, "empty");
+}
+
+void test_replay()
+{
+    std::vector<record> log;
+    log.push_back(make_record(state_machine::start{40}));
+    log.push_back(make_record(state_machine::tick{1}));
+    log.push_back(make_record(state_machine::tick{1}));
+    log.push_back(make_record(state_machine::stop{}));
+    log.push_back(make_record(state_machine::tick{1}));
+
+    state_machine m;
+    std::size_t count = 0;
+    for (const record& r : log) {
+        count += state_machine::events::process_event(m, r.type, r.data);
+    }
+    assert(count == log.size());
+    assert(m.current_state() == state_machine::Idle);
+    assert(m.value == 42);
+}
+
+void test_out_of_range()
+{
+    state_machine m;
+    state_machine::start e{1};
+    assert(!state_machine::events::process_event(m, 3, &e));
+    assert(!fsmlite::event_list<>::process_event(m, 0, &e));
+    assert(m.current_state() == state_machine::Idle);
+    assert(m.value == 0);
+}
+
+int main()
+{
+    test_index_of();
+    test_replay();
+    test_out_of_range();
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cassert>
+#include <string>
+
+#include "fsmlite.h"
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Empty, Loaded };
+
+    struct cd_detected { std::string title; };
+    struct eject {};
+
+    std::string title;
+
+private:
+    void store(const cd_detected& e) { title = e.title; }
+
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start   Event        Target  Action     Guard
+//  ----+-------+------------+-------+----------+------+-
+    row< Empty,  cd_detected, Loaded, &m::store        >,
+    row< Loaded, eject,       Empty                    >
+//  ----+-------+------------+-------+----------+------+-
+    >;
+};
+
+using pool_type = fsmlite::event_pool<fsmlite::event_list<state_machine::cd_detected, state_machine::eject>, 2>;
+
+void test_process()
+{
+    pool_type pool;
+    state_machine m;
+    auto cd = pool.acquire<state_machine::cd_detected>();
+    assert(cd);
+    cd->title = "Louie, Louie";
+    m.process_event(cd);
+    assert(m.current_state() == state_machine::Loaded);
+    assert(m.title == "Louie, Louie");
+    m.process_event(pool.acquire<state_machine::eject>());
+    assert(m.current_state() == state_machine::Empty);
+}
+
+void test_capacity()
+{
+    pool_type pool;
+    assert(pool.capacity() == 2);
+    assert(pool.available<state_machine::cd_detected>() == 2);
+    auto a = pool.acquire<state_machine::cd_detected>();
+    auto b = pool.acquire<state_machine::cd_detected>();
+    auto c = pool.acquire<state_machine::cd_detected>();
+    assert(a && b && !c);
+    assert(a.get() != b.get());
+    assert(pool.available<state_machine::cd_detected>() == 0);
+    assert(pool.available<state_machine::eject>() == 2);
+    pool.recycle();
+    assert(pool.available<state_machine::cd_detected>() == 2);
+}
+
+void test_recycle()
+{
+    pool_type pool;
+    auto a = pool.acquire<state_machine::cd_detected>();
+    a->title.assign(1000, 'x');
+    const char* data = a->title.data();
+    pool.recycle();
+    // the recycled event keeps its string buffer
+    auto b = pool.acquire<state_machine::cd_detected>();
+    assert(b.get() == a.get());
+    assert(b->title.capacity() >= 1000);
+    b->title.assign(500, 'y');
+    assert(b->title.data() == data);
+}
+
+int main()
+{
+    test_process();
+    test_capacity();
+    test_recycle();
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Running };
+
+    struct start {};
+    struct sample { int value; };
+    struct stop {};
+
+    int sum = 0;
+    int samples = 0;
+
+private:
+    void add(const sample& e) { sum += e.value; ++samples; }
+
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start    Event   Target   Action  Guard
+//  ----+--------+-------+--------+-------+------+-
+    row< Idle,    start,  Running                >,
+    row< Running, sample, Running, &m::add       >,
+    row< Running, stop,   Idle                   >
+//  ----+--------+-------+--------+-------+------+-
+    >;
+};
+
+using events = fsmlite::event_list<state_machine::start, state_machine::sample, state_machine::stop>;
+
+void test_push_pop()
+{
+    fsmlite::event_queue<events, 4> q;
+    state_machine m;
+    assert(q.capacity() == 4);
+    assert(q.empty());
+    bool popped = q.pop(m);
+    assert(!popped);
+    q.push(state_machine::start());
+    q.push(state_machine::sample{1});
+    q.push(state_machine::sample{2});
+    q.push(state_machine::stop());
+    bool pushed = q.push(state_machine::start());
+    assert(!pushed);
+    popped = q.pop(m);
+    assert(popped);
+    assert(m.current_state() == state_machine::Running);
+    std::size_t n = q.drain(m);
+    assert(n == 3);
+    assert(q.empty());
+    assert(m.current_state() == state_machine::Idle);
+    assert(m.sum == 3);
+}
+
+void test_wrap_around()
+{
+    fsmlite::event_queue<events, 3> q;
+    state_machine m;
+    q.push(state_machine::start());
+    q.drain(m);
+    for (int i = 1; i <= 10; ++i) {
+        q.push(state_machine::sample{i});
+        q.push(state_machine::sample{i});
+        std::size_t n = q.drain(m);
+        assert(n == 2);
+    }
+    assert(m.samples == 20);
+    assert(m.sum == 110);
+}
+
+// posts another event while the previous one is processed, like an
+// interrupt handler preempting the main loop
+struct reposting {
+    fsmlite::event_queue<events, 2>& queue;
+    int count;
+
+    template<class Event>
+    void process_event(const Event& event) {
+        ++count;
+        queue.push(event);
+    }
+};
+
+void test_bounded_drain()
+{
+    fsmlite::event_queue<events, 2> q;
+    reposting target{q, 0};
+    q.push(state_machine::sample{1});
+    std::size_t n = q.drain(target);
+    assert(n == 1);
+    assert(target.count == 1);
+    assert(!q.empty());
+    n = q.drain(target);
+    assert(n == 1);
+    assert(target.count == 2);
+}
+
+int main()
+{
+    test_push_pop();
+    test_wrap_around();
+    test_bounded_drain();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "fsmlite.h"
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Running, Done };
+
+    static constexpr bool collect_metrics = true;
+
+    struct start { static constexpr const char* name = "start"; };
+    struct stop { static constexpr const char* name = "stop \"now\""; };
+    struct tick {};
+
+    bool ready() const { return true; }
+    void count(const tick&) {}
+
+private:
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start    Event              Target   Action     Guard
+//  ----+--------+------------------+--------+----------+-----------+-
+    row< Idle,    start,             Running, nullptr,   &m::ready   >,
+    row< Running, tick,              Running, &m::count              >,
+    row< Running, stop,              Idle                            >,
+    row< Running, fsmlite::completion, Done,  nullptr,   false       >
+//  ----+--------+------------------+--------+----------+-----------+-
+    >;
+};
+
+struct string_writer {
+    std::string s;
+    void operator()(const char* p) { s += p; }
+};
+
+void test_dot()
+{
+    string_writer out;
+    state_machine::write_dot(out);
+    assert(out.s ==
+           "digraph {\n"
+           "  0 -> 1 [label=\"start\" + \"[]\"];\n"
+           "  1 -> 1 [label=\"#1\" + \"/\"];\n"
+           "  1 -> 0 [label=\"stop \\\"now\\\"\"];\n"
+           "  1 -> 2 [label=\"completion\" + \"[]\"];\n"
+           "}\n");
+}
+
+void test_json()
+{
+    string_writer out;
+    state_machine::write_json(out);
+    assert(out.s ==
+           "{\"states\":[0,1,2],\"rows\":["
+           "{\"start\":0,\"event\":\"start\",\"target\":1,\"action\":false,\"guard\":true},"
+           "{\"start\":1,\"event\":\"#1\",\"target\":1,\"action\":true,\"guard\":false},"
+           "{\"start\":1,\"event\":\"stop \\\"now\\\"\",\"target\":0,\"action\":false,\"guard\":false},"
+           "{\"start\":1,\"event\":\"completion\",\"target\":2,\"action\":false,\"guard\":true}"
+           "]}");
+}
+
+void test_counts()
+{
+    state_machine m;
+    m.process_event(state_machine::start());
+    m.process_event(state_machine::tick());
+    m.process_event(state_machine::tick());
+
+    string_writer dot;
+    state_machine::write_dot(dot, state_machine::metrics_snapshot());
+    assert(dot.s.find("  1 -> 1 [label=\"#1\" + \"/\", weight=2];\n") != std::string::npos);
+
+    string_writer json;
+    state_machine::write_json(json, state_machine::metrics_snapshot());
+    assert(json.s.find("\"guard\":true,\"transitions\":1}") != std::string::npos);
+    assert(json.s.find("\"guard\":false,\"transitions\":2}") != std::string::npos);
+}
+
+int main()
+{
+    test_dot();
+    test_json();
+    test_counts();
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+// stands in for external state read by guards and actions
+int sensor = 0;
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Hot, Cold };
+
+    fsmlite::guard_log* guard_log = nullptr;
+
+    struct measure {};
+
+    mutable int guard_calls = 0;
+    int last = 0;
+
+private:
+    bool hot() const { ++guard_calls; return sensor > 50; }
+    bool cold() const { ++guard_calls; return sensor < 10; }
+
+    void store(const measure&) {
+        last = guard_log ? guard_log->input([] { return sensor; }) : sensor;
+    }
+
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start  Event    Target  Action     Guard
+//  ----+------+--------+-------+----------+----------+-
+    row< Idle,  measure, Hot,    &m::store, &m::hot    >,
+    row< Idle,  measure, Cold,   &m::store, &m::cold   >,
+    row< Idle,  measure, Idle,   &m::store, true       >,
+    row< Hot,   measure, Idle                          >,
+    row< Cold,  measure, Idle                          >
+//  ----+------+--------+-------+----------+----------+-
+    >;
+};
+
+const int readings[] = { 60, 0, 5, 0, 30, 99, 0, 20 };
+
+void test_record_replay()
+{
+    unsigned char buffer[64] = {};
+
+    state_machine recorded;
+    fsmlite::guard_log record(buffer, sizeof(buffer), fsmlite::guard_log::record);
+    recorded.guard_log = &record;
+    int trace[8];
+    int values[8];
+    for (int i = 0; i != 8; ++i) {
+        sensor = readings[i];
+        recorded.process_event(state_machine::measure());
+        trace[i] = recorded.current_state();
+        values[i] = recorded.last;
+    }
+    assert(!record.overflow());
+    assert(record.bits() == static_cast<std::size_t>(recorded.guard_calls) + 32 * 5);
+
+    // replay with different external state
+    sensor = -1;
+    state_machine replayed;
+    fsmlite::guard_log replay(buffer, sizeof(buffer), fsmlite::guard_log::replay, record.bits());
+    replayed.guard_log = &replay;
+    for (int i = 0; i != 8; ++i) {
+        replayed.process_event(state_machine::measure());
+        assert(replayed.current_state() == trace[i]);
+        assert(replayed.last == values[i]);
+    }
+    assert(replayed.guard_calls == 0);
+    assert(replay.bits() == record.bits());
+    assert(!replay.overflow());
+}
+
+void test_overflow()
+{
+    unsigned char buffer[1] = {};
+    state_machine m;
+    fsmlite::guard_log record(buffer, sizeof(buffer), fsmlite::guard_log::record);
+    m.guard_log = &record;
+    sensor = 30;
+    for (int i = 0; i != 10; ++i) {
+        m.process_event(state_machine::measure());
+    }
+    assert(record.overflow());
+    assert(record.bits() == 8);
+}
+
+int main()
+{
+    test_record_replay();
+    test_overflow();
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Init, Pure, Impure, Shadowed, Constant, Exit };
+
+    state_machine(state_type init_state = Init) : fsm(init_state) {}
+
+    struct event {};
+
+    mutable int pure_calls = 0;
+    mutable int impure_calls = 0;
+
+    bool pure_guard() const { ++pure_calls; return false; }
+    bool impure_guard() const { ++impure_calls; return false; }
+
+    static constexpr bool enabled = false;
+
+private:
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start     Event  Target  Action   Guard
+//  ----+---------+------+-------+--------+-----------------+-
+    row< Pure,     event, Init,   nullptr, &m::pure_guard   >,
+    row< Pure,     event, Exit,   nullptr, &m::pure_guard   >,
+    row< Pure,     event, Exit                              >,
+    row< Impure,   event, Init,   nullptr, &m::impure_guard >,
+    row< Impure,   event, Init,   nullptr, &m::impure_guard >,
+    row< Impure,   event, Exit                              >,
+    row< Shadowed, event, Exit                              >,
+    row< Shadowed, event, Init,   nullptr, &m::pure_guard   >,
+    row< Constant, event, Init,   nullptr, m::enabled       >,
+    row< Constant, event, Exit,   nullptr, true             >,
+    row< Constant, event, Init                              >
+//  ----+---------+------+-------+--------+-----------------+-
+    >;
+};
+
+template<>
+struct fsmlite::is_pure_guard<&state_machine::pure_guard> : std::true_type {};
+
+void test_pure()
+{
+    state_machine m(state_machine::Pure);
+    m.process_event(state_machine::event());
+    assert(m.current_state() == state_machine::Exit);
+    assert(m.pure_calls == 1);
+}
+
+void test_impure()
+{
+    state_machine m(state_machine::Impure);
+    m.process_event(state_machine::event());
+    assert(m.current_state() == state_machine::Exit);
+    assert(m.impure_calls == 2);
+}
+
+void test_shadowed()
+{
+    state_machine m(state_machine::Shadowed);
+    m.process_event(state_machine::event());
+    assert(m.current_state() == state_machine::Exit);
+    assert(m.pure_calls == 0);
+}
+
+void test_constant()
+{
+    state_machine m(state_machine::Constant);
+    m.process_event(state_machine::event());
+    assert(m.current_state() == state_machine::Exit);
+}
+
+int main()
+{
+    test_pure();
+    test_impure();
+    test_shadowed();
+    test_constant();
+    return 0;
+}
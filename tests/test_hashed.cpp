@@ -0,0 +1,123 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+// sparse protocol codes as states
+class state_machine: public fsmlite::fsm<state_machine, unsigned> {
+    friend class fsmlite::fsm<state_machine, unsigned>;  // base class needs access to transition_table
+public:
+    static constexpr bool hashed_dispatch = true;
+
+    static constexpr unsigned Init = 0x1000;
+    static constexpr unsigned Ready = 0x7f00;
+    static constexpr unsigned Busy = 0x12345;
+    static constexpr unsigned Done = 0xdead0000;
+    static constexpr unsigned Error = 0xffffffff;
+
+    state_machine(state_type init_state = Init) : fsm(init_state) {}
+
+    struct next { bool ok; };
+    struct reset {};
+
+    int errors = 0;
+
+    template<class Event>
+    state_type no_transition(const Event&) {
+        ++errors;
+        return Error;
+    }
+
+private:
+    static bool ok(const next& e) { return e.ok; }
+
+    using transition_table = table<
+//       Start  Event  Target  Action   Guard
+//  ----+------+------+-------+--------+----------+-
+    row< Init,  next,  Ready,  nullptr, &ok       >,
+    row< Ready, next,  Busy,   nullptr, &ok       >,
+    row< Busy,  next,  Done,   nullptr, &ok       >,
+    row< Busy,  next,  Ready                      >,
+    row< Done,  reset, Init                       >,
+    row< Error, reset, Init                       >
+//  ----+------+------+-------+--------+----------+-
+    >;
+};
+
+void test_sparse()
+{
+    state_machine m;
+    m.process_event(state_machine::next{true});
+    assert(m.current_state() == state_machine::Ready);
+    m.process_event(state_machine::next{true});
+    assert(m.current_state() == state_machine::Busy);
+    m.process_event(state_machine::next{false});
+    assert(m.current_state() == state_machine::Ready);
+    m.process_event(state_machine::next{true});
+    m.process_event(state_machine::next{true});
+    assert(m.current_state() == state_machine::Done);
+    m.process_event(state_machine::next{true});
+    assert(m.current_state() == state_machine::Error);
+    assert(m.errors == 1);
+    m.process_event(state_machine::reset());
+    assert(m.current_state() == state_machine::Init);
+}
+
+void test_unknown_state()
+{
+    state_machine m(0x4242);
+    m.process_event(state_machine::next{true});
+    assert(m.current_state() == state_machine::Error);
+    assert(m.errors == 1);
+}
+
+#if __cplusplus >= 202002L
+// structural class type as state
+struct code {
+    unsigned short major;
+    unsigned short minor;
+    constexpr bool operator==(const code&) const = default;
+};
+
+template<>
+struct fsmlite::state_key<code> {
+    static constexpr unsigned long long get(code c) { return c.major * 0x10000ull + c.minor; }
+};
+
+class protocol: public fsmlite::fsm<protocol, code> {
+    friend class fsmlite::fsm<protocol, code>;  // base class needs access to transition_table
+public:
+    static constexpr bool hashed_dispatch = true;
+
+    protocol() : fsm(code{1, 0}) {}
+
+    struct upgrade {};
+
+private:
+    using transition_table = table<
+//       Start         Event    Target
+//  ----+-------------+--------+-------------+-
+    row< code{1, 0},   upgrade, code{2, 0}    >,
+    row< code{2, 0},   upgrade, code{700, 3}  >
+//  ----+-------------+--------+-------------+-
+    >;
+};
+
+void test_structural()
+{
+    protocol p;
+    p.process_event(protocol::upgrade());
+    assert((p.current_state() == code{2, 0}));
+    p.process_event(protocol::upgrade());
+    assert((p.current_state() == code{700, 3}));
+}
+#endif
+
+int main()
+{
+    test_sparse();
+    test_unknown_state();
+#if __cplusplus >= 202002L
+    test_structural();
+#endif
+    return 0;
+}
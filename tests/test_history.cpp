@@ -0,0 +1,113 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class counter: public fsmlite::fsm<counter, int, 4> {
+    friend class fsmlite::fsm<counter, int, 4>;  // base class needs access to transition_table
+public:
+    struct inc {};
+    struct reset {};
+
+private:
+    // count events without matching rows
+    template<class Event>
+    state_type no_transition(const Event&) {
+        return current_state() + 1;
+    }
+
+private:
+    using transition_table = table<
+//       Start Event  Target
+//  ----+-----+------+------+-
+    row< 0,    reset, 0      >
+//  ----+-----+------+------+-
+    >;
+};
+
+class plain: public fsmlite::fsm<plain> {
+    friend class fsmlite::fsm<plain>;  // base class needs access to transition_table
+public:
+    struct event {};
+
+private:
+    using transition_table = table<
+        row< 0, event, 1 >
+    >;
+};
+
+void test_rollback()
+{
+    counter c;
+    assert(c.history_size() == 0);
+    assert(c.rollback(0));
+    assert(!c.rollback(1));
+    c.process_event(counter::inc());
+    c.process_event(counter::inc());
+    assert(c.current_state() == 2);
+    assert(c.history_size() == 2);
+    assert(c.rollback());
+    assert(c.current_state() == 1);
+    assert(c.history_size() == 1);
+    assert(!c.rollback(2));
+    assert(c.current_state() == 1);
+    assert(c.rollback(1));
+    assert(c.current_state() == 0);
+    assert(c.history_size() == 0);
+}
+
+void test_ring()
+{
+    counter c;
+    for (int i = 0; i != 10; ++i) {
+        c.process_event(counter::inc());
+    }
+    assert(c.current_state() == 10);
+    assert(c.history_size() == 4);
+    assert(!c.rollback(5));
+    assert(c.rollback(4));
+    assert(c.current_state() == 6);
+    assert(c.history_size() == 0);
+}
+
+void test_checkpoint()
+{
+    counter c;
+    c.process_event(counter::inc());
+    counter::checkpoint_type cp = c.checkpoint();
+    c.process_event(counter::inc());
+    c.process_event(counter::inc());
+    assert(c.current_state() == 3);
+    assert(c.restore(cp));
+    assert(c.current_state() == 1);
+    assert(c.restore(cp));
+    assert(c.current_state() == 1);
+    for (int i = 0; i != 5; ++i) {
+        c.process_event(counter::inc());
+    }
+    assert(!c.restore(cp));
+    assert(c.current_state() == 6);
+    assert(c.restore(c.checkpoint()));
+    assert(!c.restore(c.checkpoint() + 1));
+}
+
+void test_no_history()
+{
+    static_assert(sizeof(plain) == sizeof(fsmlite::fsm<plain>), "no history overhead");
+    plain p;
+    p.process_event(plain::event());
+    assert(p.current_state() == 1);
+    assert(p.history_size() == 0);
+    assert(!p.rollback());
+    assert(p.rollback(0));
+    assert(p.restore(p.checkpoint()));
+    assert(p.current_state() == 1);
+}
+
+int main()
+{
+    test_rollback();
+    test_ring();
+    test_checkpoint();
+    test_no_history();
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+template<bool Shared>
+class state_machine: public fsmlite::fsm<state_machine<Shared>> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Running };
+
+    static constexpr bool collect_metrics = true;
+    static constexpr bool shared_dispatch = Shared;
+
+    struct start {};
+    struct stop {};
+    struct reset {};
+
+    template<class Event>
+    typename fsmlite::fsm<state_machine>::state_type no_transition(const Event&) {
+        return this->current_state();
+    }
+
+private:
+    using base = fsmlite::fsm<state_machine>;
+
+    template<states start, class Event, states target>
+    using row = typename base::template row<start, Event, target>;
+
+    using transition_table = typename base::template table<
+//       Start    Event  Target
+//  ----+--------+------+--------+-
+    row< Idle,    start, Running >,
+    row< Running, stop,  Idle    >,
+    row< Running, start, Running >
+//  ----+--------+------+--------+-
+    >;
+};
+
+template<bool Shared>
+void test_metrics()
+{
+    using m = state_machine<Shared>;
+    m a, b;
+    a.process_event(typename m::start());
+    a.process_event(typename m::start());
+    b.process_event(typename m::stop());
+    b.process_event(typename m::start());
+    b.process_event(typename m::stop());
+    b.process_event(typename m::reset());
+
+    auto snapshot = m::metrics_snapshot();
+    assert(snapshot.template processed<typename m::start>() == 3);
+    assert(snapshot.template processed<typename m::stop>() == 2);
+    assert(snapshot.template rejected<typename m::start>() == 0);
+    assert(snapshot.template rejected<typename m::stop>() == 1);
+    assert(snapshot.transitions[0] == 2);
+    assert(snapshot.transitions[1] == 1);
+    assert(snapshot.transitions[2] == 1);
+    // events not contained in the transition table are not counted
+    assert(snapshot.template processed<typename m::reset>() == 0);
+    static_assert(decltype(snapshot)::event_types::size() == 2);
+}
+
+int main()
+{
+    test_metrics<false>();
+    test_metrics<true>();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+struct sample { int value; };
+struct alert { int level; };
+struct ack {};
+
+class sensor: public fsmlite::fsm<sensor> {
+    friend class fsmlite::fsm<sensor>;  // base class needs access to transition_table
+public:
+    enum states { Idle };
+
+    int samples = 0;
+    int acks = 0;
+
+    static alert to_alert(const sample& s) { return alert{s.value / 10}; }
+
+private:
+    void count(const sample&) { ++samples; }
+    void count_ack(const ack&) { ++acks; }
+
+    using m = sensor;
+
+    using transition_table = table<
+//       Start  Event   Target  Action
+//  ----+------+-------+-------+-------------+-
+    row< Idle,  sample, Idle,   &m::count     >,
+    row< Idle,  ack,    Idle,   &m::count_ack >
+//  ----+------+-------+-------+-------------+-
+    >;
+};
+
+class monitor: public fsmlite::fsm<monitor> {
+    friend class fsmlite::fsm<monitor>;  // base class needs access to transition_table
+public:
+    enum states { Normal, Alarmed };
+
+    int level = 0;
+
+private:
+    void store(const alert& a) { level = a.level; }
+
+    using m = monitor;
+
+    using transition_table = table<
+//       Start    Event  Target   Action
+//  ----+--------+------+--------+---------+-
+    row< Normal,  alert, Alarmed, &m::store >,
+    row< Alarmed, alert, Alarmed, &m::store >
+//  ----+--------+------+--------+---------+-
+    >;
+};
+
+class logger: public fsmlite::fsm<logger> {
+    friend class fsmlite::fsm<logger>;  // base class needs access to transition_table
+public:
+    enum states { Ready };
+
+    int entries = 0;
+    int order = 0;
+    int* clock = nullptr;
+
+private:
+    void log(const alert&) { ++entries; if (clock) order = ++*clock; }
+    void log_sample(const sample&) { ++entries; if (clock) order = ++*clock; }
+
+    using m = logger;
+
+    using transition_table = table<
+//       Start  Event   Target  Action
+//  ----+------+-------+-------+---------------+-
+    row< Ready, alert,  Ready,  &m::log         >,
+    row< Ready, sample, Ready,  &m::log_sample  >
+//  ----+------+-------+-------+---------------+-
+    >;
+};
+
+// alert processing acknowledges back to the sensor
+ack acknowledge(const alert&) { return ack{}; }
+
+void test_acyclic()
+{
+    using net_type = fsmlite::network<fsmlite::wiring<
+        fsmlite::route<sensor, sample, monitor, &sensor::to_alert>,
+        fsmlite::route<monitor, alert, logger>,
+        fsmlite::route<sensor, sample, logger>
+    >>;
+    static_assert(!net_type::has_back_edges());
+
+    net_type net;
+    int clock = 0;
+    net.get<logger>().clock = &clock;
+    net.process_event<sensor>(sample{42});
+    assert(net.get<sensor>().samples == 1);
+    assert(net.get<monitor>().current_state() == monitor::Alarmed);
+    assert(net.get<monitor>().level == 4);
+    // the alert is logged before the sample, in route order
+    assert(net.get<logger>().entries == 2);
+    assert(net.get<logger>().order == 2);
+}
+
+void test_back_edge()
+{
+    using net_type = fsmlite::network<fsmlite::wiring<
+        fsmlite::route<sensor, sample, monitor, &sensor::to_alert>,
+        fsmlite::route<monitor, alert, sensor, &acknowledge>
+    >, 4>;
+    static_assert(net_type::has_back_edges());
+
+    net_type net;
+    net.process_event<sensor>(sample{10});
+    net.process_event<sensor>(sample{20});
+    assert(net.get<sensor>().samples == 2);
+    assert(net.get<sensor>().acks == 2);
+    assert(net.get<monitor>().level == 2);
+    assert(net.dropped() == 0);
+}
+
+int main()
+{
+    test_acyclic();
+    test_back_edge();
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+class state_machine: public fsmlite::fsm<state_machine> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+public:
+    enum states { Idle, Running, Paused, Stopped };
+
+    state_machine(state_type init_state = Idle) : fsm(init_state) {}
+
+    struct start {};
+    struct pause {};
+    struct reload {};
+
+    int reloads = 0;
+
+private:
+    void count(const reload&) { ++reloads; }
+
+    using m = state_machine;
+
+    using transition_table = table<
+//       Start    Event   Target   Action     Guard
+//  ----+--------+-------+--------+----------+------+-
+    row< Idle,    start,  Running                   >,
+    row< Running, pause,  Paused                    >,
+    row< Paused,  start,  Running                   >,
+    row< Running, reload, Paused,  &m::count        >,
+    row< Paused,  reload, Idle,    &m::count        >
+//  ----+--------+-------+--------+----------+------+-
+    >;
+};
+
+using population_type = fsmlite::population<state_machine, 8>;
+
+void test_emplace()
+{
+    population_type p;
+    assert(p.capacity() == 8);
+    for (int i = 0; i != 8; ++i) {
+        std::size_t index = p.emplace();
+        assert(index == static_cast<std::size_t>(i));
+        (void)index;
+    }
+    std::size_t full = p.emplace();
+    assert(full == p.capacity());
+    assert(p.size() == 8);
+}
+
+void test_process_event()
+{
+    population_type p;
+    p.emplace();
+    p.emplace(state_machine::Stopped);
+    p.process_event(0, state_machine::start());
+    assert(p[0].current_state() == state_machine::Running);
+    p.process_event(1, state_machine::start());
+    assert(p[1].current_state() == state_machine::Stopped);
+}
+
+void test_broadcast()
+{
+    population_type p;
+    p.emplace(state_machine::Idle);
+    p.emplace(state_machine::Running);
+    p.emplace(state_machine::Paused);
+    p.emplace(state_machine::Stopped);
+    p.emplace(state_machine::Running);
+
+    // Running -> Paused must not be visited again in its new state
+    std::size_t n = p.broadcast(state_machine::reload());
+    assert(n == 3);
+    assert(p[0].current_state() == state_machine::Idle);
+    assert(p[1].current_state() == state_machine::Paused);
+    assert(p[2].current_state() == state_machine::Idle);
+    assert(p[3].current_state() == state_machine::Stopped);
+    assert(p[4].current_state() == state_machine::Paused);
+    assert(p[0].reloads == 0 && p[1].reloads == 1 && p[2].reloads == 1 && p[4].reloads == 1);
+
+    n = p.broadcast(state_machine::start());
+    assert(n == 4);
+    n = p.broadcast(state_machine::pause());
+    assert(n == 4);
+    n = p.broadcast(state_machine::reload());
+    assert(n == 4);
+    assert(p[0].current_state() == state_machine::Idle);
+    assert(p[3].current_state() == state_machine::Stopped);
+    (void)n;
+}
+
+int main()
+{
+    test_emplace();
+    test_process_event();
+    test_broadcast();
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <cassert>
+#include <string>
+
+#include "fsmlite.h"
+
+class player: public fsmlite::fsm<player> {
+    friend class fsmlite::fsm<player>;  // base class needs access to transition_table
+public:
+    enum states { Stopped, Open, Empty, Playing, Paused, Error };
+
+    player(state_type init_state = Empty) : fsm(init_state) { }
+
+    void set_autoplay(bool f) { autoplay = f; }
+
+    const std::string& get_cd_title() const { return cd_title; }
+
+    struct play {};
+    struct open_close {};
+    struct cd_detected {
+        std::string title;
+        bool bad() const { return title.empty(); }
+    };
+    struct stop {};
+    struct pause {};
+
+    using events = fsmlite::event_list<play, open_close, cd_detected, stop, pause>;
+
+    using runtime_table = fsmlite::runtime_table<player, events, 8, 16>;
+
+    // registries, referred to by one-based index from runtime rows
+    static const runtime_table::action_type actions[];
+    static const runtime_table::guard_type guards[];
+
+    int transitions = 0;
+
+private:
+    template<class Event>
+    state_type no_transition(const Event&) {
+        return Error;
+    }
+
+    bool is_autoplay() const { return autoplay; }
+    void open_drawer() { cd_title.clear(); ++transitions; }
+    void store_cd_info(const cd_detected& cd) { cd_title = cd.title; ++transitions; }
+    void count() { ++transitions; }
+
+private:
+    std::string cd_title;
+    bool autoplay = false;
+};
+
+using m = player;
+
+const player::runtime_table::action_type player::actions[] = {
+    runtime_table::action_for<open_close, &m::open_drawer>,    // 1
+    runtime_table::action_for<cd_detected, &m::open_drawer>,   // 2
+    runtime_table::action_for<cd_detected, &m::store_cd_info>, // 3
+    runtime_table::action_for<play, &m::count>,                // 4
+    runtime_table::action_for<stop, &m::count>                 // 5
+};
+
+const player::runtime_table::guard_type player::guards[] = {
+    runtime_table::guard_for<cd_detected, &cd_detected::bad>,  // 1
+    runtime_table::guard_for<cd_detected, &m::is_autoplay>     // 2
+};
+
+// as it would be read from a file
+const fsmlite::runtime_row rows[] = {
+//   Start        Event  Target       Action Guard
+    { m::Stopped, 0,     m::Playing,  4,     0 },
+    { m::Stopped, 1,     m::Open,     1,     0 },
+    { m::Open,    1,     m::Empty,    0,     0 },
+    { m::Empty,   1,     m::Open,     1,     0 },
+    { m::Empty,   2,     m::Open,     2,     1 },
+    { m::Empty,   2,     m::Playing,  3,     2 },
+    { m::Empty,   2,     m::Stopped,  3,     0 },
+    { m::Playing, 3,     m::Stopped,  5,     0 },
+    { m::Playing, 4,     m::Paused,   0,     0 },
+    { m::Paused,  0,     m::Playing,  4,     0 },
+    { m::Paused,  3,     m::Stopped,  5,     0 }
+};
+
+const std::size_t nrows = sizeof(rows) / sizeof(rows[0]);
+
+void test_load()
+{
+    player::runtime_table table;
+    assert(table.size() == 0);
+    assert(table.load(rows, nrows, player::actions, 5, player::guards, 2));
+    assert(table.size() == nrows);
+
+    // invalid state, event, action and guard references
+    fsmlite::runtime_row bad[] = {
+        { 8, 0, 0, 0, 0 },
+        { 0, 5, 0, 0, 0 },
+        { 0, 0, 8, 0, 0 },
+        { 0, 0, 0, 6, 0 },
+        { 0, 0, 0, 1, 0 },
+        { 0, 0, 0, 0, 1 }
+    };
+    for (const fsmlite::runtime_row& r : bad) {
+        assert(!table.load(&r, 1, player::actions, 5, player::guards, 2));
+        assert(table.size() == 0);
+    }
+    assert(!table.load(rows, 17));
+    assert(table.size() == 0);
+}
+
+void test_process()
+{
+    player::runtime_table table;
+    table.load(rows, nrows, player::actions, 5, player::guards, 2);
+
+    player p;
+    p.process_event(table, player::open_close());
+    assert(p.current_state() == player::Open);
+    p.process_event(table, player::open_close());
+    assert(p.current_state() == player::Empty);
+    p.process_event(table, player::cd_detected{"louie, louie"});
+    assert(p.current_state() == player::Stopped);
+    assert(p.get_cd_title() == "louie, louie");
+    p.process_event(table, player::play());
+    assert(p.current_state() == player::Playing);
+    p.process_event(table, player::pause());
+    assert(p.current_state() == player::Paused);
+    p.process_event(table, player::stop());
+    assert(p.current_state() == player::Stopped);
+    assert(p.transitions == 4);
+    p.process_event(table, player::pause());
+    assert(p.current_state() == player::Error);
+    p.process_event(table, player::play());
+    assert(p.current_state() == player::Error);
+}
+
+void test_guards()
+{
+    player::runtime_table table;
+    table.load(rows, nrows, player::actions, 5, player::guards, 2);
+
+    player p;
+    p.process_event(table, player::cd_detected{});
+    assert(p.current_state() == player::Open);
+
+    player q;
+    q.set_autoplay(true);
+    q.process_event(table, player::cd_detected{"help!"});
+    assert(q.current_state() == player::Playing);
+    assert(q.get_cd_title() == "help!");
+}
+
+int main()
+{
+    test_load();
+    test_process();
+    test_guards();
+    return 0;
+}
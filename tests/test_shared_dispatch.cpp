@@ -0,0 +1,131 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+template<bool Shared>
+class door: public fsmlite::fsm<door<Shared>> {
+    friend class fsmlite::fsm<door>;  // base class needs access to transition_table
+public:
+    enum states { Closed, Open, Locked };
+
+    static constexpr bool shared_dispatch = Shared;
+
+    door(states init_state = Closed) : fsmlite::fsm<door>(init_state) {}
+
+    struct open {};
+    struct close {};
+    struct lock { bool key; };
+
+    int opened = 0;
+    int closed = 0;
+    int rejected = 0;
+
+    template<class Event>
+    typename fsmlite::fsm<door>::state_type no_transition(const Event&) {
+        ++rejected;
+        return this->current_state();
+    }
+
+private:
+    void count_open(const open&) { ++opened; }
+    void count_close(const close&) { ++closed; }
+    bool has_key(const lock& e) const { return e.key; }
+
+    using m = door;
+    using base = fsmlite::fsm<door>;
+
+    template<states start, class Event, states target, auto action = nullptr, auto guard = nullptr>
+    using row = typename base::template row<start, Event, target, action, guard>;
+
+    using transition_table = typename base::template table<
+//       Start   Event  Target  Action          Guard
+//  ----+-------+------+-------+---------------+------------+-
+    row< Closed, open,  Open,   &m::count_open               >,
+    row< Open,   close, Closed, &m::count_close              >,
+    row< Closed, lock,  Locked, nullptr,        &m::has_key  >,
+    row< Closed, lock,  Closed                               >,
+    row< Locked, open,  Locked                               >
+//  ----+-------+------+-------+---------------+------------+-
+    >;
+};
+
+// a different machine with the same table layout
+class valve: public fsmlite::fsm<valve> {
+    friend class fsmlite::fsm<valve>;  // base class needs access to transition_table
+public:
+    enum states { Shut, Flowing, Sealed };
+
+    static constexpr bool shared_dispatch = true;
+
+    valve() : fsm(Shut) {}
+
+    struct open {};
+    struct close {};
+    struct lock { bool key; };
+
+    int flows = 0;
+
+private:
+    void start_flow(const open&) { ++flows; }
+    void stop_flow(const close&) { --flows; }
+    bool has_key(const lock& e) const { return e.key; }
+
+    using transition_table = table<
+//       Start    Event  Target   Action             Guard
+//  ----+--------+------+--------+------------------+----------------+-
+    row< Shut,    open,  Flowing, &valve::start_flow                  >,
+    row< Flowing, close, Shut,    &valve::stop_flow                   >,
+    row< Shut,    lock,  Sealed,  nullptr,           &valve::has_key  >,
+    row< Shut,    lock,  Shut                                         >,
+    row< Sealed,  open,  Sealed                                       >
+//  ----+--------+------+--------+------------------+----------------+-
+    >;
+};
+
+template<class Door>
+void run(Door& d)
+{
+    using door_type = typename std::remove_reference<Door>::type;
+    d.process_event(typename door_type::close());
+    d.process_event(typename door_type::open());
+    d.process_event(typename door_type::open());
+    d.process_event(typename door_type::close());
+    d.process_event(typename door_type::lock{false});
+    d.process_event(typename door_type::lock{true});
+    d.process_event(typename door_type::open());
+}
+
+void test_equivalent()
+{
+    door<false> a;
+    door<true> b;
+    run(a);
+    run(b);
+    assert(a.current_state() == door<false>::Locked);
+    assert(b.current_state() == door<true>::Locked);
+    assert(a.opened == b.opened && b.opened == 1);
+    assert(a.closed == b.closed && b.closed == 1);
+    assert(a.rejected == b.rejected && b.rejected == 2);
+}
+
+void test_shared_layout()
+{
+    valve v;
+    v.process_event(valve::open());
+    assert(v.current_state() == valve::Flowing);
+    assert(v.flows == 1);
+    v.process_event(valve::close());
+    assert(v.current_state() == valve::Shut);
+    assert(v.flows == 0);
+    v.process_event(valve::lock{false});
+    assert(v.current_state() == valve::Shut);
+    v.process_event(valve::lock{true});
+    assert(v.current_state() == valve::Sealed);
+}
+
+int main()
+{
+    test_equivalent();
+    test_shared_layout();
+    return 0;
+}
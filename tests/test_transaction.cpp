@@ -0,0 +1,86 @@
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+#include "fsmlite.h"
+
+class account: public fsmlite::fsm<account> {
+    friend class fsmlite::fsm<account>;  // base class needs access to transition_table
+public:
+    enum states { Open, Closed, Error };
+
+    struct transfer { std::vector<int> amounts; };
+    struct close {};
+
+    int balance = 0;
+    int compensations = 0;
+
+private:
+    void apply(const transfer& t) {
+        applied = 0;
+        for (int amount : t.amounts) {
+#if !__GNUC__ || __EXCEPTIONS
+            if (balance + amount < 0) {
+                throw std::runtime_error("insufficient funds");
+            }
+#endif
+            balance += amount;
+            applied += amount;
+        }
+    }
+
+    void revert() {
+        balance -= applied;
+        ++compensations;
+    }
+
+    int applied = 0;
+
+private:
+    using m = account;
+
+    using transition_table = table<
+//                   Start  Event     Target  Action     Compensation Error
+//  ----------------+------+---------+-------+----------+------------+------+-
+    transaction_row< Open,  transfer, Open,   &m::apply, &m::revert,  Error >,
+    row<             Open,  close,    Closed                                >,
+    row<             Error, close,    Closed                                >
+//  ----------------+------+---------+-------+----------+------------+------+-
+    >;
+};
+
+void test_commit()
+{
+    account a;
+    a.process_event(account::transfer{{10, 20, -5}});
+    assert(a.current_state() == account::Open);
+    assert(a.balance == 25);
+    assert(a.compensations == 0);
+    a.process_event(account::close());
+    assert(a.current_state() == account::Closed);
+}
+
+void test_rollback()
+{
+    account a;
+    a.process_event(account::transfer{{10}});
+    assert(a.balance == 10);
+#if !__GNUC__ || __EXCEPTIONS
+    a.process_event(account::transfer{{5, 5, -30}});
+    assert(a.current_state() == account::Error);
+    assert(a.balance == 10);
+    assert(a.compensations == 1);
+    a.process_event(account::transfer{{5}});
+    assert(a.current_state() == account::Error);
+    assert(a.balance == 10);
+    a.process_event(account::close());
+    assert(a.current_state() == account::Closed);
+#endif
+}
+
+int main()
+{
+    test_commit();
+    test_rollback();
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <cassert>
+
+#include "fsmlite.h"
+
+template<bool Shared, bool Hashed>
+class state_machine: public fsmlite::fsm<state_machine<Shared, Hashed>> {
+    friend class fsmlite::fsm<state_machine>;  // base class needs access to transition_table
+    using base = fsmlite::fsm<state_machine>;
+public:
+    static constexpr bool shared_dispatch = Shared;
+    static constexpr bool hashed_dispatch = Hashed;
+
+    enum states { Idle, Running, Stopped };
+
+    struct start {};
+    struct stop { bool ok; };
+
+    int started = 0;
+
+private:
+    void on_start(const start&) { ++started; }
+
+    static bool ok(const stop& e) { return e.ok; }
+
+    template<auto start, class Event, auto target, auto action = nullptr, auto guard = nullptr>
+    using row = typename base::template row<start, Event, target, action, guard>;
+
+    using transition_table = typename base::template table<
+//       Start    Event  Target   Action                     Guard
+//  ----+--------+------+--------+--------------------------+------+-
+    row< Idle,    start, Running, &state_machine::on_start          >,
+    row< Running, stop,  Stopped, nullptr,                   &ok    >,
+    row< Running, stop,  Idle                                       >,
+    row< Stopped, start, Running, &state_machine::on_start          >
+//  ----+--------+------+--------+--------------------------+------+-
+    >;
+};
+
+class digits: public fsmlite::fsm<digits> {
+    friend class fsmlite::fsm<digits>;  // base class needs access to transition_table
+public:
+    enum states { Init, Number };
+
+private:
+    using digit = fsmlite::char_range<'0', '9'>;
+
+    using transition_table = table<
+//       Start   Event  Target
+//  ----+-------+------+-------+-
+    row< Init,   digit, Number  >,
+    row< Number, digit, Number  >
+//  ----+-------+------+-------+-
+    >;
+};
+
+template<class Machine>
+void test_machine()
+{
+    std::size_t size = Machine::warm();
+    assert(size != 0);
+    assert(Machine::warm() == size);
+    (void)size;
+
+    Machine m;
+    m.process_event(typename Machine::start{});
+    assert(m.current_state() == Machine::Running);
+    m.process_event(typename Machine::stop{false});
+    assert(m.current_state() == Machine::Idle);
+    m.process_event(typename Machine::start{});
+    m.process_event(typename Machine::stop{true});
+    assert(m.current_state() == Machine::Stopped);
+    m.process_event(typename Machine::start{});
+    assert(m.current_state() == Machine::Running);
+    assert(m.started == 3);
+}
+
+void test_engines()
+{
+    test_machine<state_machine<false, false>>();
+    test_machine<state_machine<true, false>>();
+    test_machine<state_machine<false, true>>();
+
+    // dispatch engines add their own tables
+    using chain = state_machine<false, false>;
+    using shared = state_machine<true, false>;
+    using hashed = state_machine<false, true>;
+    assert(shared::warm() > chain::warm());
+    assert(hashed::warm() > chain::warm());
+}
+
+void test_bytes()
+{
+    std::size_t size = digits::warm();
+    assert(size != 0);
+    (void)size;
+
+    digits m;
+    m.process_bytes("123", 3);
+    assert(m.current_state() == digits::Number);
+}
+
+int main()
+{
+    test_engines();
+    test_bytes();
+    return 0;
+}